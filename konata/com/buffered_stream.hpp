@@ -0,0 +1,344 @@
+/*
+buffered_stream.hpp: Copyright (c) Egtra 2026
+
+Distributed under the Boost Software License, Version 1.0.
+(See accompanying file LICENSE.txt or copy at
+http://www.boost.org/LICENSE_1_0.txt )
+*/
+
+#ifndef KONATA_COM_BUFFERED_STREAM_HPP
+#define KONATA_COM_BUFFERED_STREAM_HPP
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+#include <konata/com/stream_types.hpp>
+
+namespace konata
+{
+namespace com
+{
+
+// Read-ahead and write-behind buffering in front of a stream with the
+// IStream methods (an IStream such as handle_stream_impl, or
+// fd_stream_impl), so that small reads and writes do not each cost a
+// call into the kernel. Pending writes reach the stream on Commit, Seek,
+// SetSize, Stat, a following Read, flush() and destruction. A Seek that
+// lands inside the read-ahead only moves within it, and Seek(0,
+// STREAM_SEEK_CUR) is answered without flushing. The stream must not be
+// used directly while this object holds buffered data.
+template<typename Stream>
+class buffered_stream
+{
+public:
+  explicit buffered_stream(Stream* stream, ULONG readBufferSize = 64 * 1024, ULONG writeBufferSize = 64 * 1024)
+    : m_stream(stream),
+    m_readSize(std::max<ULONG>(readBufferSize, 1)),
+    m_writeSize(std::max<ULONG>(writeBufferSize, 1)),
+    m_buffer(new char[std::max(m_readSize, m_writeSize)]),
+    m_mode(idle), m_begin(0), m_end(0), m_bufferStart(0), m_positionKnown(false)
+  {
+    LARGE_INTEGER zero;
+    zero.QuadPart = 0;
+    ULARGE_INTEGER pos;
+    if (SUCCEEDED(m_stream->Seek(zero, STREAM_SEEK_CUR, &pos)))
+    {
+      m_bufferStart = pos.QuadPart;
+      m_positionKnown = true;
+    }
+  }
+
+  buffered_stream(const buffered_stream&) = delete;
+  buffered_stream& operator=(const buffered_stream&) = delete;
+
+  ~buffered_stream()
+  {
+    flush();
+  }
+
+  HRESULT Read(void* pv, ULONG cb, ULONG* pcbRead) noexcept
+  {
+    HRESULT hr = flush();
+    if (FAILED(hr))
+      return hr;
+    char* out = static_cast<char*>(pv);
+    ULONG done = 0;
+    if (m_mode == reading)
+    {
+      done = std::min(cb, m_end - m_begin);
+      std::memcpy(out, m_buffer.get() + m_begin, done);
+      m_begin += done;
+    }
+    while (done < cb)
+    {
+      drop_read_buffer();
+      ULONG want = cb - done;
+      ULONG got = 0;
+      if (want >= m_readSize)
+      {
+        // Too large to gain from the buffer.
+        hr = m_stream->Read(out + done, want, &got);
+        if (FAILED(hr))
+          break;
+        done += got;
+        m_bufferStart += got;
+        if (got < want)
+          break;
+      }
+      else
+      {
+        hr = m_stream->Read(m_buffer.get(), m_readSize, &got);
+        if (FAILED(hr))
+          break;
+        ULONG n = std::min(want, got);
+        std::memcpy(out + done, m_buffer.get(), n);
+        m_mode = reading;
+        m_begin = n;
+        m_end = got;
+        done += n;
+        if (n < want)
+          break;
+      }
+    }
+    if (pcbRead != nullptr)
+      *pcbRead = done;
+    if (FAILED(hr))
+      return hr;
+    return done < cb ? S_FALSE : S_OK;
+  }
+
+  HRESULT Write(const void* pv, ULONG cb, ULONG* pcbWritten) noexcept
+  {
+    HRESULT hr = unread();
+    if (SUCCEEDED(hr) && m_mode == writing && m_end + static_cast<std::uint64_t>(cb) > m_writeSize)
+      hr = flush();
+    if (FAILED(hr))
+    {
+      if (pcbWritten != nullptr)
+        *pcbWritten = 0;
+      return hr;
+    }
+    if (cb >= m_writeSize)
+    {
+      ULONG written = 0;
+      hr = m_stream->Write(pv, cb, &written);
+      m_bufferStart += written;
+      if (pcbWritten != nullptr)
+        *pcbWritten = written;
+      return hr;
+    }
+    std::memcpy(m_buffer.get() + m_end, pv, cb);
+    m_end += cb;
+    m_mode = writing;
+    if (pcbWritten != nullptr)
+      *pcbWritten = cb;
+    return S_OK;
+  }
+
+  HRESULT Seek(
+    LARGE_INTEGER dlibMove,
+    DWORD dwOrigin,
+    ULARGE_INTEGER* plibNewPosition) noexcept
+  {
+    std::int64_t move = dlibMove.QuadPart;
+    if (m_positionKnown && (dwOrigin == STREAM_SEEK_SET || dwOrigin == STREAM_SEEK_CUR))
+    {
+      std::uint64_t current = position();
+      if (dwOrigin == STREAM_SEEK_CUR && move == 0)
+        return report(current, plibNewPosition);
+      std::uint64_t target = dwOrigin == STREAM_SEEK_SET ? static_cast<std::uint64_t>(move) : current + static_cast<std::uint64_t>(move);
+      if (m_mode == reading && (dwOrigin == STREAM_SEEK_CUR || move >= 0)
+        && target >= m_bufferStart && target <= m_bufferStart + m_end)
+      {
+        m_begin = static_cast<ULONG>(target - m_bufferStart);
+        return report(target, plibNewPosition);
+      }
+    }
+    HRESULT hr = flush();
+    if (FAILED(hr))
+      return hr;
+    if (m_mode == reading && dwOrigin == STREAM_SEEK_CUR)
+      dlibMove.QuadPart -= m_end - m_begin; // the stream is ahead by the unread bytes
+    ULARGE_INTEGER pos;
+    hr = m_stream->Seek(dlibMove, dwOrigin, &pos);
+    if (FAILED(hr))
+      return hr;
+    m_mode = idle;
+    m_begin = m_end = 0;
+    m_bufferStart = pos.QuadPart;
+    m_positionKnown = true;
+    return report(pos.QuadPart, plibNewPosition);
+  }
+
+  HRESULT SetSize(ULARGE_INTEGER libNewSize) noexcept
+  {
+    HRESULT hr = flush();
+    if (SUCCEEDED(hr))
+      hr = unread();
+    if (FAILED(hr))
+      return hr;
+    return m_stream->SetSize(libNewSize);
+  }
+
+  // Drains the read-ahead into pstm, then leaves the rest to the stream's
+  // own CopyTo (which for fd_stream_impl stays inside the kernel).
+  template<typename Destination>
+  HRESULT CopyTo(
+    Destination* pstm,
+    ULARGE_INTEGER cb,
+    ULARGE_INTEGER* pcbRead,
+    ULARGE_INTEGER* pcbWritten) noexcept
+  {
+    std::uint64_t read = 0;
+    std::uint64_t written = 0;
+    HRESULT hr = flush();
+    if (SUCCEEDED(hr) && m_mode == reading)
+    {
+      ULONG n = static_cast<ULONG>(std::min<std::uint64_t>(cb.QuadPart, m_end - m_begin));
+      ULONG put = 0;
+      hr = pstm->Write(m_buffer.get() + m_begin, n, &put);
+      m_begin += n;
+      read += n;
+      written += put;
+    }
+    if (SUCCEEDED(hr) && read < cb.QuadPart)
+    {
+      drop_read_buffer();
+      ULARGE_INTEGER rest;
+      rest.QuadPart = cb.QuadPart - read;
+      ULARGE_INTEGER r;
+      ULARGE_INTEGER w;
+      r.QuadPart = w.QuadPart = 0;
+      hr = m_stream->CopyTo(pstm, rest, &r, &w);
+      read += r.QuadPart;
+      written += w.QuadPart;
+      m_bufferStart += r.QuadPart;
+    }
+    if (pcbRead != nullptr)
+      pcbRead->QuadPart = read;
+    if (pcbWritten != nullptr)
+      pcbWritten->QuadPart = written;
+    return hr;
+  }
+
+  HRESULT Commit(DWORD grfCommitFlags) noexcept
+  {
+    HRESULT hr = flush();
+    if (FAILED(hr))
+      return hr;
+    return m_stream->Commit(grfCommitFlags);
+  }
+  HRESULT Revert() noexcept
+  {
+    return m_stream->Revert();
+  }
+  HRESULT LockRegion(
+    ULARGE_INTEGER libOffset,
+    ULARGE_INTEGER cb,
+    DWORD dwLockType) noexcept
+  {
+    return m_stream->LockRegion(libOffset, cb, dwLockType);
+  }
+  HRESULT UnlockRegion(
+    ULARGE_INTEGER libOffset,
+    ULARGE_INTEGER cb,
+    DWORD dwLockType) noexcept
+  {
+    return m_stream->UnlockRegion(libOffset, cb, dwLockType);
+  }
+  HRESULT Stat(
+    STATSTG* pstatstg,
+    DWORD grfStatFlag) noexcept
+  {
+    HRESULT hr = flush();
+    if (FAILED(hr))
+      return hr;
+    return m_stream->Stat(pstatstg, grfStatFlag);
+  }
+
+  // Hands the pending writes to the stream (without committing them).
+  HRESULT flush() noexcept
+  {
+    if (m_mode != writing)
+      return S_OK;
+    ULONG pending = m_end;
+    ULONG written = 0;
+    HRESULT hr = m_stream->Write(m_buffer.get(), pending, &written);
+    m_bufferStart += written;
+    m_mode = idle;
+    m_begin = m_end = 0;
+    return hr;
+  }
+
+  Stream* get() const noexcept { return m_stream; }
+
+private:
+  enum mode
+  {
+    idle,
+    reading,
+    writing,
+  };
+
+  std::uint64_t position() const noexcept
+  {
+    return m_bufferStart + (m_mode == reading ? m_begin : m_mode == writing ? m_end : 0);
+  }
+
+  static HRESULT report(std::uint64_t pos, ULARGE_INTEGER* plibNewPosition) noexcept
+  {
+    if (plibNewPosition != nullptr)
+      plibNewPosition->QuadPart = pos;
+    return S_OK;
+  }
+
+  // Forgets a fully consumed read-ahead; the stream is at its end.
+  void drop_read_buffer() noexcept
+  {
+    if (m_mode == reading)
+    {
+      m_bufferStart += m_end;
+      m_mode = idle;
+      m_begin = m_end = 0;
+    }
+  }
+
+  // Moves the stream back over the read-ahead not yet consumed, before
+  // writing where the reader stands.
+  HRESULT unread() noexcept
+  {
+    if (m_mode != reading)
+      return S_OK;
+    if (m_begin < m_end)
+    {
+      LARGE_INTEGER back;
+      back.QuadPart = -static_cast<std::int64_t>(m_end - m_begin);
+      HRESULT hr = m_stream->Seek(back, STREAM_SEEK_CUR, nullptr);
+      if (FAILED(hr))
+        return hr;
+    }
+    m_bufferStart += m_begin;
+    m_mode = idle;
+    m_begin = m_end = 0;
+    return S_OK;
+  }
+
+  Stream* m_stream;
+  ULONG m_readSize;
+  ULONG m_writeSize;
+  std::unique_ptr<char[]> m_buffer;
+  mode m_mode;
+  ULONG m_begin; // reading: next unread byte
+  ULONG m_end; // reading: bytes buffered; writing: bytes pending
+  std::uint64_t m_bufferStart; // stream position of m_buffer[0]
+  bool m_positionKnown; // false for unseekable streams such as pipes
+};
+
+} // namespace com
+} // namespace konata
+
+#endif // KONATA_COM_BUFFERED_STREAM_HPP
@@ -0,0 +1,356 @@
+/*
+fd_stream.hpp: Copyright (c) Egtra 2026
+
+Distributed under the Boost Software License, Version 1.0.
+(See accompanying file LICENSE.txt or copy at
+http://www.boost.org/LICENSE_1_0.txt )
+*/
+
+#ifndef KONATA_COM_FD_STREAM_HPP
+#define KONATA_COM_FD_STREAM_HPP
+
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <system_error>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+
+#include <konata/com/stream_types.hpp>
+
+namespace konata
+{
+namespace com
+{
+
+// The counterpart of handle_stream_impl over a POSIX file descriptor,
+// with the same methods: Seek is lseek, SetSize ftruncate, Stat fstat and
+// Commit fsync. The descriptor is not owned; see fd_stream.
+class fd_stream_impl
+{
+public:
+  HRESULT Read(void* pv, ULONG cb, ULONG* pcbRead) noexcept
+  {
+    ssize_t n;
+    do
+    {
+      n = ::read(m_fd, pv, cb);
+    } while (n < 0 && errno == EINTR);
+    if (n < 0)
+      return hresult_from_errno(errno);
+    if (pcbRead != nullptr)
+      *pcbRead = static_cast<ULONG>(n);
+    return static_cast<ULONG>(n) < cb ? S_FALSE : S_OK;
+  }
+  HRESULT Write(const void* pv, ULONG cb, ULONG* pcbWritten) noexcept
+  {
+    // Unlike WriteFile, write may stop short (pipes, sockets, signals).
+    const char* p = static_cast<const char*>(pv);
+    ULONG written = 0;
+    HRESULT hr = S_OK;
+    while (written < cb)
+    {
+      ssize_t n = ::write(m_fd, p + written, cb - written);
+      if (n < 0)
+      {
+        if (errno == EINTR)
+          continue;
+        hr = hresult_from_errno(errno);
+        break;
+      }
+      written += static_cast<ULONG>(n);
+    }
+    if (pcbWritten != nullptr)
+      *pcbWritten = written;
+    return hr;
+  }
+  HRESULT Seek(
+    LARGE_INTEGER dlibMove,
+    DWORD dwOrigin,
+    ULARGE_INTEGER* plibNewPosition) noexcept
+  {
+    int whence;
+    switch (dwOrigin)
+    {
+    case STREAM_SEEK_SET:
+      whence = SEEK_SET;
+      break;
+    case STREAM_SEEK_CUR:
+      whence = SEEK_CUR;
+      break;
+    case STREAM_SEEK_END:
+      whence = SEEK_END;
+      break;
+    default:
+      return STG_E_INVALIDFUNCTION;
+    }
+    off_t pos = ::lseek(m_fd, static_cast<off_t>(dlibMove.QuadPart), whence);
+    if (pos < 0)
+      return hresult_from_errno(errno);
+    if (plibNewPosition != nullptr)
+      plibNewPosition->QuadPart = static_cast<std::uint64_t>(pos);
+    return S_OK;
+  }
+  HRESULT SetSize(ULARGE_INTEGER libNewSize) noexcept
+  {
+    if (::ftruncate(m_fd, static_cast<off_t>(libNewSize.QuadPart)) != 0)
+      return hresult_from_errno(errno);
+    return S_OK;
+  }
+  // Copies with copy_file_range, sendfile or splice, whichever the two
+  // descriptors support, so that the data never passes through user
+  // space; failing all of them, through a buffer.
+  HRESULT CopyTo(
+    fd_stream_impl* pstm,
+    ULARGE_INTEGER cb,
+    ULARGE_INTEGER* pcbRead,
+    ULARGE_INTEGER* pcbWritten) noexcept
+  {
+    if (pstm == nullptr)
+      return E_POINTER;
+    std::uint64_t remaining = cb.QuadPart;
+    std::uint64_t read = 0;
+    std::uint64_t written = 0;
+    HRESULT hr = S_OK;
+    int method = 0;
+    bool eof = false;
+    while (remaining > 0 && method < copy_buffered)
+    {
+      std::size_t chunk = static_cast<std::size_t>(std::min<std::uint64_t>(remaining, 1u << 30));
+      ssize_t n = kernel_copy(method, pstm->m_fd, chunk);
+      if (n < 0)
+      {
+        if (errno == EINTR)
+          continue;
+        if (errno == EINVAL || errno == EXDEV || errno == ENOSYS || errno == EOPNOTSUPP || errno == EBADF)
+        {
+          // Not supported between these descriptors; nothing was moved.
+          ++method;
+          continue;
+        }
+        hr = hresult_from_errno(errno);
+        break;
+      }
+      if (n == 0)
+      {
+        eof = true;
+        break;
+      }
+      read += static_cast<std::uint64_t>(n);
+      written += static_cast<std::uint64_t>(n);
+      remaining -= static_cast<std::uint64_t>(n);
+    }
+    if (SUCCEEDED(hr) && !eof && remaining > 0)
+      hr = copy_through_buffer(pstm, remaining, read, written);
+    if (pcbRead != nullptr)
+      pcbRead->QuadPart = read;
+    if (pcbWritten != nullptr)
+      pcbWritten->QuadPart = written;
+    return hr;
+  }
+  // Copies into any other stream with a Write method, through a buffer.
+  template<typename Stream>
+  typename std::enable_if<!std::is_base_of<fd_stream_impl, Stream>::value, HRESULT>::type CopyTo(
+    Stream* pstm,
+    ULARGE_INTEGER cb,
+    ULARGE_INTEGER* pcbRead,
+    ULARGE_INTEGER* pcbWritten) noexcept
+  {
+    if (pstm == nullptr)
+      return E_POINTER;
+    std::uint64_t read = 0;
+    std::uint64_t written = 0;
+    HRESULT hr = copy_through_buffer(pstm, cb.QuadPart, read, written);
+    if (pcbRead != nullptr)
+      pcbRead->QuadPart = read;
+    if (pcbWritten != nullptr)
+      pcbWritten->QuadPart = written;
+    return hr;
+  }
+  HRESULT Commit(DWORD /*grfCommitFlags*/) noexcept
+  {
+    if (::fsync(m_fd) != 0 && errno != EINVAL && errno != EROFS)
+      return hresult_from_errno(errno);
+    return S_OK;
+  }
+  HRESULT Revert() noexcept
+  {
+    return E_NOTIMPL;
+  }
+  HRESULT LockRegion(
+    ULARGE_INTEGER /*libOffset*/,
+    ULARGE_INTEGER /*cb*/,
+    DWORD /*dwLockType*/) noexcept
+  {
+    return E_NOTIMPL;
+  }
+  HRESULT UnlockRegion(
+    ULARGE_INTEGER /*libOffset*/,
+    ULARGE_INTEGER /*cb*/,
+    DWORD /*dwLockType*/) noexcept
+  {
+    return E_NOTIMPL;
+  }
+  HRESULT Stat(
+    STATSTG* pstatstg,
+    DWORD /*grfStatFlag*/) noexcept
+  {
+    if (pstatstg == nullptr)
+      return E_POINTER;
+    *pstatstg = STATSTG();
+    struct stat st;
+    if (::fstat(m_fd, &st) != 0)
+      return hresult_from_errno(errno);
+    pstatstg->type = STGTY_STREAM;
+    pstatstg->cbSize.QuadPart = static_cast<std::uint64_t>(st.st_size);
+    pstatstg->mtime = filetime_from_timespec(st.st_mtim);
+    pstatstg->ctime = filetime_from_timespec(st.st_ctim);
+    pstatstg->atime = filetime_from_timespec(st.st_atim);
+    int flags = ::fcntl(m_fd, F_GETFL);
+    if (flags >= 0)
+    {
+      switch (flags & O_ACCMODE)
+      {
+      case O_WRONLY:
+        pstatstg->grfMode = STGM_WRITE;
+        break;
+      case O_RDWR:
+        pstatstg->grfMode = STGM_READWRITE;
+        break;
+      default:
+        pstatstg->grfMode = STGM_READ;
+        break;
+      }
+    }
+    return S_OK;
+  }
+  // A clone would need its own seek pointer, which dup does not give.
+  HRESULT Clone(fd_stream_impl** ppstm) noexcept
+  {
+    if (ppstm != nullptr)
+      *ppstm = nullptr;
+    return E_NOTIMPL;
+  }
+
+  int get_fd() const noexcept { return m_fd; }
+
+protected:
+  explicit fd_stream_impl(int fd = -1) : m_fd(fd) {}
+  void set_fd(int fd) noexcept { m_fd = fd; }
+
+private:
+  enum
+  {
+    copy_file_range_method,
+    sendfile_method,
+    splice_method,
+    copy_buffered,
+  };
+
+  // Moves up to n bytes from this descriptor to out at both file
+  // offsets: the byte count, 0 at the end of input, or -1 with errno.
+  ssize_t kernel_copy(int method, int out, std::size_t n) noexcept
+  {
+#ifdef __linux__
+    switch (method)
+    {
+    case copy_file_range_method:
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 27))
+      // Same or cross file system (since Linux 5.3); may reflink.
+      return ::copy_file_range(m_fd, nullptr, out, nullptr, n, 0);
+#else
+      errno = ENOSYS;
+      return -1;
+#endif
+    case sendfile_method:
+      // Input must be mappable (a regular file); output anything.
+      return ::sendfile(out, m_fd, nullptr, n);
+    case splice_method:
+      // Either side must be a pipe.
+      return ::splice(m_fd, nullptr, out, nullptr, n, SPLICE_F_MOVE);
+    }
+#else
+    static_cast<void>(method);
+    static_cast<void>(out);
+    static_cast<void>(n);
+#endif
+    errno = ENOSYS;
+    return -1;
+  }
+
+  template<typename Stream>
+  HRESULT copy_through_buffer(Stream* pstm, std::uint64_t remaining, std::uint64_t& read, std::uint64_t& written) noexcept
+  {
+    const ULONG bufferSize = 64 * 1024;
+    std::unique_ptr<char[]> buffer(new (std::nothrow) char[bufferSize]);
+    if (buffer == nullptr)
+      return E_OUTOFMEMORY;
+    while (remaining > 0)
+    {
+      ULONG n = static_cast<ULONG>(std::min<std::uint64_t>(remaining, bufferSize));
+      ULONG got = 0;
+      HRESULT hr = Read(buffer.get(), n, &got);
+      if (FAILED(hr))
+        return hr;
+      if (got == 0)
+        break;
+      read += got;
+      remaining -= got;
+      ULONG put = 0;
+      hr = pstm->Write(buffer.get(), got, &put);
+      written += put;
+      if (FAILED(hr))
+        return hr;
+    }
+    return S_OK;
+  }
+
+  int m_fd;
+};
+
+// An fd_stream_impl that owns its descriptor.
+class fd_stream : public fd_stream_impl
+{
+public:
+  explicit fd_stream(int fd) noexcept : fd_stream_impl(fd) {}
+
+  fd_stream(const char* path, int flags, mode_t mode = 0666)
+    : fd_stream_impl(::open(path, flags | O_CLOEXEC, mode))
+  {
+    if (get_fd() < 0)
+      throw std::system_error(errno, std::generic_category(), path);
+  }
+
+  fd_stream(const fd_stream&) = delete;
+  fd_stream& operator=(const fd_stream&) = delete;
+
+  ~fd_stream()
+  {
+    if (get_fd() >= 0)
+      ::close(get_fd());
+  }
+
+  // Gives up ownership of the descriptor.
+  int release() noexcept
+  {
+    int fd = get_fd();
+    set_fd(-1);
+    return fd;
+  }
+};
+
+} // namespace com
+} // namespace konata
+
+#endif // KONATA_COM_FD_STREAM_HPP
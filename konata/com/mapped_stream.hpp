@@ -0,0 +1,439 @@
+/*
+mapped_stream.hpp: Copyright (c) Egtra 2026
+
+Distributed under the Boost Software License, Version 1.0.
+(See accompanying file LICENSE.txt or copy at
+http://www.boost.org/LICENSE_1_0.txt )
+*/
+
+#ifndef KONATA_COM_MAPPED_STREAM_HPP
+#define KONATA_COM_MAPPED_STREAM_HPP
+
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <konata/com/stream_types.hpp>
+
+namespace konata
+{
+namespace com
+{
+
+enum class mapped_advice
+{
+  normal,
+  sequential,
+  random,
+  willneed,
+};
+
+struct mapped_stream_options
+{
+  // Bytes mapped at a time; larger files are viewed through a window that
+  // moves with the position. Rounded up to the page size.
+  std::size_t window_size = std::size_t(256) << 20;
+  mapped_advice advice = mapped_advice::sequential;
+  // Map for writing; the file then grows (by at least growth_step bytes)
+  // to take writes past its end, and is trimmed to the bytes written on
+  // Commit and destruction.
+  bool writable = false;
+  std::size_t growth_step = std::size_t(1) << 20;
+};
+
+// Contiguous bytes of the mapping handed out by mapped_stream::borrow.
+class mapped_span
+{
+public:
+  mapped_span() noexcept : m_data(nullptr), m_size(0) {}
+  mapped_span(const unsigned char* data, std::size_t size) noexcept : m_data(data), m_size(size) {}
+
+  const unsigned char* data() const noexcept { return m_data; }
+  std::size_t size() const noexcept { return m_size; }
+  bool empty() const noexcept { return m_size == 0; }
+  const unsigned char* begin() const noexcept { return m_data; }
+  const unsigned char* end() const noexcept { return m_data + m_size; }
+
+private:
+  const unsigned char* m_data;
+  std::size_t m_size;
+};
+
+// A stream with the methods of handle_stream_impl over a memory-mapped
+// file: Read is a memcpy from the mapping, and borrow() lets a parser work
+// on the mapped bytes in place. The file must not be truncated by anyone
+// else while it is mapped (touching pages past the end raises SIGBUS).
+class mapped_stream
+{
+public:
+  // Maps fd, which stays owned by the caller.
+  explicit mapped_stream(int fd, const mapped_stream_options& options = mapped_stream_options())
+    : m_fd(fd), m_ownsFd(false)
+  {
+    init(options);
+  }
+
+  mapped_stream(const char* path, const mapped_stream_options& options = mapped_stream_options(), mode_t mode = 0666)
+    : m_fd(::open(path, (options.writable ? O_RDWR | O_CREAT : O_RDONLY) | O_CLOEXEC, mode)), m_ownsFd(true)
+  {
+    if (m_fd < 0)
+      throw std::system_error(errno, std::generic_category(), path);
+    init(options);
+  }
+
+  mapped_stream(const mapped_stream&) = delete;
+  mapped_stream& operator=(const mapped_stream&) = delete;
+
+  ~mapped_stream()
+  {
+    unmap();
+    if (m_capacity > m_size)
+      static_cast<void>(::ftruncate(m_fd, static_cast<off_t>(m_size)));
+    if (m_ownsFd)
+      ::close(m_fd);
+  }
+
+  HRESULT Read(void* pv, ULONG cb, ULONG* pcbRead) noexcept
+  {
+    unsigned char* out = static_cast<unsigned char*>(pv);
+    ULONG done = 0;
+    HRESULT hr = S_OK;
+    while (done < cb && m_position < m_size)
+    {
+      hr = map(m_position, cb - done);
+      if (FAILED(hr))
+        break;
+      std::size_t n = contiguous(cb - done);
+      std::memcpy(out + done, m_window + (m_position - m_windowStart), n);
+      done += static_cast<ULONG>(n);
+      m_position += n;
+    }
+    if (pcbRead != nullptr)
+      *pcbRead = done;
+    if (FAILED(hr))
+      return hr;
+    return done < cb ? S_FALSE : S_OK;
+  }
+  HRESULT Write(const void* pv, ULONG cb, ULONG* pcbWritten) noexcept
+  {
+    if (pcbWritten != nullptr)
+      *pcbWritten = 0;
+    if (!m_options.writable)
+      return STG_E_ACCESSDENIED;
+    // Nothing to write, even past the end, leaves the size alone.
+    if (cb == 0)
+      return S_OK;
+    HRESULT hr = reserve(m_position + cb);
+    if (FAILED(hr))
+      return hr;
+    if (m_position + cb > m_size)
+      m_size = m_position + cb;
+    const unsigned char* in = static_cast<const unsigned char*>(pv);
+    ULONG done = 0;
+    while (done < cb)
+    {
+      hr = map(m_position, cb - done);
+      if (FAILED(hr))
+        break;
+      std::size_t n = contiguous(cb - done);
+      std::memcpy(m_window + (m_position - m_windowStart), in + done, n);
+      done += static_cast<ULONG>(n);
+      m_position += n;
+    }
+    if (pcbWritten != nullptr)
+      *pcbWritten = done;
+    return hr;
+  }
+  HRESULT Seek(
+    LARGE_INTEGER dlibMove,
+    DWORD dwOrigin,
+    ULARGE_INTEGER* plibNewPosition) noexcept
+  {
+    std::int64_t base;
+    switch (dwOrigin)
+    {
+    case STREAM_SEEK_SET:
+      base = 0;
+      break;
+    case STREAM_SEEK_CUR:
+      base = static_cast<std::int64_t>(m_position);
+      break;
+    case STREAM_SEEK_END:
+      base = static_cast<std::int64_t>(m_size);
+      break;
+    default:
+      return STG_E_INVALIDFUNCTION;
+    }
+    std::int64_t pos = base + dlibMove.QuadPart;
+    if (pos < 0)
+      return STG_E_INVALIDFUNCTION;
+    // The window moves on the next access, if need be.
+    m_position = static_cast<std::uint64_t>(pos);
+    if (plibNewPosition != nullptr)
+      plibNewPosition->QuadPart = m_position;
+    return S_OK;
+  }
+  HRESULT SetSize(ULARGE_INTEGER libNewSize) noexcept
+  {
+    if (!m_options.writable)
+      return STG_E_ACCESSDENIED;
+    if (libNewSize.QuadPart < m_windowStart + m_windowLength)
+      unmap();
+    if (::ftruncate(m_fd, static_cast<off_t>(libNewSize.QuadPart)) != 0)
+      return hresult_from_errno(errno);
+    m_size = m_capacity = libNewSize.QuadPart;
+    return S_OK;
+  }
+  // Writes straight from the mapping into pstm.
+  template<typename Destination>
+  HRESULT CopyTo(
+    Destination* pstm,
+    ULARGE_INTEGER cb,
+    ULARGE_INTEGER* pcbRead,
+    ULARGE_INTEGER* pcbWritten) noexcept
+  {
+    std::uint64_t read = 0;
+    std::uint64_t written = 0;
+    HRESULT hr = pstm != nullptr ? S_OK : E_POINTER;
+    while (SUCCEEDED(hr) && read < cb.QuadPart && m_position < m_size)
+    {
+      ULONG want = static_cast<ULONG>(std::min<std::uint64_t>(cb.QuadPart - read, 1u << 30));
+      hr = map(m_position, want);
+      if (FAILED(hr))
+        break;
+      ULONG n = static_cast<ULONG>(contiguous(want));
+      ULONG put = 0;
+      hr = pstm->Write(m_window + (m_position - m_windowStart), n, &put);
+      read += n;
+      written += put;
+      m_position += n;
+    }
+    if (pcbRead != nullptr)
+      pcbRead->QuadPart = read;
+    if (pcbWritten != nullptr)
+      pcbWritten->QuadPart = written;
+    return hr;
+  }
+  // Trims the file to the bytes written and, unless
+  // STGC_DANGEROUSLYCOMMITMERELYTODISKCACHE is given, writes the dirty
+  // pages to disk.
+  HRESULT Commit(DWORD grfCommitFlags) noexcept
+  {
+    if (!m_options.writable)
+      return S_OK;
+    if (m_capacity > m_size)
+    {
+      if (m_windowStart + m_windowLength > m_size)
+        unmap();
+      if (::ftruncate(m_fd, static_cast<off_t>(m_size)) != 0)
+        return hresult_from_errno(errno);
+      m_capacity = m_size;
+    }
+    if ((grfCommitFlags & STGC_DANGEROUSLYCOMMITMERELYTODISKCACHE) == 0 && ::fsync(m_fd) != 0)
+      return hresult_from_errno(errno);
+    return S_OK;
+  }
+  HRESULT Revert() noexcept
+  {
+    return E_NOTIMPL;
+  }
+  HRESULT LockRegion(
+    ULARGE_INTEGER /*libOffset*/,
+    ULARGE_INTEGER /*cb*/,
+    DWORD /*dwLockType*/) noexcept
+  {
+    return E_NOTIMPL;
+  }
+  HRESULT UnlockRegion(
+    ULARGE_INTEGER /*libOffset*/,
+    ULARGE_INTEGER /*cb*/,
+    DWORD /*dwLockType*/) noexcept
+  {
+    return E_NOTIMPL;
+  }
+  HRESULT Stat(
+    STATSTG* pstatstg,
+    DWORD /*grfStatFlag*/) noexcept
+  {
+    if (pstatstg == nullptr)
+      return E_POINTER;
+    *pstatstg = STATSTG();
+    struct stat st;
+    if (::fstat(m_fd, &st) != 0)
+      return hresult_from_errno(errno);
+    pstatstg->type = STGTY_STREAM;
+    pstatstg->cbSize.QuadPart = m_size;
+    pstatstg->mtime = filetime_from_timespec(st.st_mtim);
+    pstatstg->ctime = filetime_from_timespec(st.st_ctim);
+    pstatstg->atime = filetime_from_timespec(st.st_atim);
+    pstatstg->grfMode = m_options.writable ? STGM_READWRITE : STGM_READ;
+    return S_OK;
+  }
+  HRESULT Clone(mapped_stream** ppstm) noexcept
+  {
+    if (ppstm != nullptr)
+      *ppstm = nullptr;
+    return E_NOTIMPL;
+  }
+
+  // Up to cb bytes at the current position, in place, without moving the
+  // position (see consume). Shorter at the end of the file and where a
+  // window ends; a span of more than window_size bytes is never returned.
+  // Valid until the window moves: the next Read, Write, CopyTo, borrow,
+  // SetSize or Commit.
+  mapped_span borrow(std::size_t cb) noexcept
+  {
+    if (m_position >= m_size || FAILED(map(m_position, cb)))
+      return mapped_span();
+    return mapped_span(m_window + (m_position - m_windowStart), contiguous(cb));
+  }
+
+  // Advances the position past bytes obtained with borrow.
+  void consume(std::size_t n) noexcept
+  {
+    m_position += n;
+  }
+
+  // Changes the madvise hint, for the current window and later ones.
+  void advise(mapped_advice advice) noexcept
+  {
+    m_options.advice = advice;
+    if (m_window != nullptr)
+      apply_advice();
+  }
+
+  std::uint64_t size() const noexcept { return m_size; }
+  std::uint64_t position() const noexcept { return m_position; }
+  int get_fd() const noexcept { return m_fd; }
+
+private:
+  void init(const mapped_stream_options& options)
+  {
+    m_options = options;
+    m_window = nullptr;
+    m_windowStart = 0;
+    m_windowLength = 0;
+    m_position = 0;
+    std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    m_pageMask = ~static_cast<std::uint64_t>(page - 1);
+    std::size_t window = std::max(m_options.window_size, page);
+    m_options.window_size = (window + page - 1) & ~(page - 1);
+    struct stat st;
+    if (::fstat(m_fd, &st) != 0)
+    {
+      int e = errno;
+      if (m_ownsFd)
+        ::close(m_fd);
+      throw std::system_error(e, std::generic_category(), "fstat");
+    }
+    m_size = m_capacity = static_cast<std::uint64_t>(st.st_size);
+  }
+
+  // Makes the window cover [pos, pos + need), or as much of it as a
+  // window can hold, within the file.
+  HRESULT map(std::uint64_t pos, std::size_t need) noexcept
+  {
+    std::uint64_t limit = m_options.writable ? m_capacity : m_size;
+    if (m_window != nullptr && pos >= m_windowStart && pos < m_windowStart + m_windowLength
+      && (pos + need <= m_windowStart + m_windowLength || m_windowStart + m_windowLength == limit
+        || pos - m_windowStart < m_options.window_size / 2))
+    {
+      return S_OK;
+    }
+    unmap();
+    if (pos >= limit)
+      return S_OK;
+    std::uint64_t start = pos & m_pageMask;
+    std::size_t length = static_cast<std::size_t>(std::min<std::uint64_t>(m_options.window_size, limit - start));
+    int prot = m_options.writable ? PROT_READ | PROT_WRITE : PROT_READ;
+    void* p = ::mmap(nullptr, length, prot, MAP_SHARED, m_fd, static_cast<off_t>(start));
+    if (p == MAP_FAILED)
+      return hresult_from_errno(errno);
+    m_window = static_cast<unsigned char*>(p);
+    m_windowStart = start;
+    m_windowLength = length;
+    apply_advice();
+    return S_OK;
+  }
+
+  void unmap() noexcept
+  {
+    if (m_window != nullptr)
+      ::munmap(m_window, m_windowLength);
+    m_window = nullptr;
+    m_windowStart = 0;
+    m_windowLength = 0;
+  }
+
+  void apply_advice() noexcept
+  {
+    int advice = MADV_NORMAL;
+    switch (m_options.advice)
+    {
+    case mapped_advice::normal:
+      break;
+    case mapped_advice::sequential:
+      advice = MADV_SEQUENTIAL;
+      break;
+    case mapped_advice::random:
+      advice = MADV_RANDOM;
+      break;
+    case mapped_advice::willneed:
+      advice = MADV_WILLNEED;
+      break;
+    }
+    ::madvise(m_window, m_windowLength, advice);
+  }
+
+  // Bytes available at m_position in the window, up to n, not past the
+  // logical end of the file (which Write moves before copying).
+  std::size_t contiguous(std::size_t n) const noexcept
+  {
+    if (m_window == nullptr || m_position >= m_size)
+      return 0;
+    std::uint64_t end = std::min<std::uint64_t>(m_windowStart + m_windowLength, m_size);
+    return static_cast<std::size_t>(std::min<std::uint64_t>(n, end - m_position));
+  }
+
+  // Grows the file so that it holds size bytes.
+  HRESULT reserve(std::uint64_t size) noexcept
+  {
+    if (size <= m_capacity)
+      return S_OK;
+    std::uint64_t capacity = std::max<std::uint64_t>(size, m_capacity + std::max<std::uint64_t>(m_capacity / 2, m_options.growth_step));
+    if (::ftruncate(m_fd, static_cast<off_t>(capacity)) != 0)
+      return hresult_from_errno(errno);
+    m_capacity = capacity;
+    // A window cut short by the old end of the file is now stale.
+    if (m_window != nullptr && m_windowLength < m_options.window_size)
+      unmap();
+    return S_OK;
+  }
+
+  int m_fd;
+  bool m_ownsFd;
+  mapped_stream_options m_options;
+  std::uint64_t m_size; // logical size
+  std::uint64_t m_capacity; // file size; beyond m_size while writing
+  std::uint64_t m_position;
+  std::uint64_t m_pageMask;
+  unsigned char* m_window;
+  std::uint64_t m_windowStart;
+  std::size_t m_windowLength;
+};
+
+} // namespace com
+} // namespace konata
+
+#endif // KONATA_COM_MAPPED_STREAM_HPP
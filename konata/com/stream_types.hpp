@@ -0,0 +1,135 @@
+/*
+stream_types.hpp: Copyright (c) Egtra 2026
+
+Distributed under the Boost Software License, Version 1.0.
+(See accompanying file LICENSE.txt or copy at
+http://www.boost.org/LICENSE_1_0.txt )
+*/
+
+#ifndef KONATA_COM_STREAM_TYPES_HPP
+#define KONATA_COM_STREAM_TYPES_HPP
+
+#pragma once
+
+#ifdef _WIN32
+
+#include <ole2.h>
+
+#else
+
+#include <cstdint>
+#include <ctime>
+
+namespace konata
+{
+namespace com
+{
+
+// The part of the COM vocabulary that the IStream methods use, so that
+// stream classes on POSIX systems keep the shape of handle_stream_impl.
+// The values are those of the Windows SDK.
+
+typedef std::int32_t HRESULT;
+typedef std::uint32_t ULONG;
+typedef std::uint32_t DWORD;
+
+union LARGE_INTEGER
+{
+  std::int64_t QuadPart;
+};
+
+union ULARGE_INTEGER
+{
+  std::uint64_t QuadPart;
+};
+
+struct FILETIME
+{
+  DWORD dwLowDateTime;
+  DWORD dwHighDateTime;
+};
+
+// pwcsName and clsid are left out: names are never returned
+// (STATFLAG_NONAME) and streams have no class.
+struct STATSTG
+{
+  DWORD type;
+  ULARGE_INTEGER cbSize;
+  FILETIME mtime;
+  FILETIME ctime;
+  FILETIME atime;
+  DWORD grfMode;
+  DWORD grfLocksSupported;
+  DWORD grfStateBits;
+  DWORD reserved;
+};
+
+constexpr HRESULT S_OK = 0;
+constexpr HRESULT S_FALSE = 1;
+constexpr HRESULT E_NOTIMPL = static_cast<HRESULT>(0x80004001);
+constexpr HRESULT E_POINTER = static_cast<HRESULT>(0x80004003);
+constexpr HRESULT E_OUTOFMEMORY = static_cast<HRESULT>(0x8007000E);
+constexpr HRESULT E_INVALIDARG = static_cast<HRESULT>(0x80070057);
+constexpr HRESULT STG_E_INVALIDFUNCTION = static_cast<HRESULT>(0x80030001);
+constexpr HRESULT STG_E_ACCESSDENIED = static_cast<HRESULT>(0x80030005);
+
+enum STREAM_SEEK : DWORD
+{
+  STREAM_SEEK_SET = 0,
+  STREAM_SEEK_CUR = 1,
+  STREAM_SEEK_END = 2,
+};
+
+enum STGC : DWORD
+{
+  STGC_DEFAULT = 0,
+  STGC_OVERWRITE = 1,
+  STGC_ONLYIFCURRENT = 2,
+  STGC_DANGEROUSLYCOMMITMERELYTODISKCACHE = 4,
+  STGC_CONSOLIDATE = 8,
+};
+
+enum STGTY : DWORD
+{
+  STGTY_STORAGE = 1,
+  STGTY_STREAM = 2,
+  STGTY_LOCKBYTES = 3,
+  STGTY_PROPERTY = 4,
+};
+
+enum STATFLAG : DWORD
+{
+  STATFLAG_DEFAULT = 0,
+  STATFLAG_NONAME = 1,
+  STATFLAG_NOOPEN = 2,
+};
+
+constexpr DWORD STGM_READ = 0x00000000;
+constexpr DWORD STGM_WRITE = 0x00000001;
+constexpr DWORD STGM_READWRITE = 0x00000002;
+
+inline bool FAILED(HRESULT hr) noexcept { return hr < 0; }
+inline bool SUCCEEDED(HRESULT hr) noexcept { return hr >= 0; }
+
+// errno values travel in FACILITY_ITF, where interfaces keep their own codes.
+inline HRESULT hresult_from_errno(int e) noexcept
+{
+  return e == 0 ? S_OK : static_cast<HRESULT>(0x80040000u | (static_cast<unsigned>(e) & 0xFFFFu));
+}
+
+inline FILETIME filetime_from_timespec(const timespec& t) noexcept
+{
+  // 100ns intervals since 1601-01-01.
+  std::uint64_t ticks = (static_cast<std::uint64_t>(t.tv_sec) + 11644473600u) * 10000000u + static_cast<std::uint64_t>(t.tv_nsec) / 100;
+  FILETIME ft;
+  ft.dwLowDateTime = static_cast<DWORD>(ticks);
+  ft.dwHighDateTime = static_cast<DWORD>(ticks >> 32);
+  return ft;
+}
+
+} // namespace com
+} // namespace konata
+
+#endif // _WIN32
+
+#endif // KONATA_COM_STREAM_TYPES_HPP
@@ -0,0 +1,260 @@
+// konata/jni/array.hpp
+//
+// Copyright (c) Egtra 2026
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt )
+
+#ifndef KONATA_JNI_ARRAY_HPP
+#define KONATA_JNI_ARRAY_HPP
+
+#include <cstddef>
+#include <memory>
+#include <jni.h>
+
+#if __cplusplus >= 202002L || (defined(_MSVC_LANG) && _MSVC_LANG >= 202002L)
+#include <span>
+#define KONATA_JNI_HAS_SPAN
+#endif
+
+namespace konata
+{
+namespace jni
+{
+
+namespace detail {
+
+// Release modes: 0 copies back and frees, JNI_COMMIT copies back and keeps
+// the elements, JNI_ABORT frees without copying back.
+template<typename ArrayT, typename ElemT, void (JNIEnv::*ReleaseFunction)(ArrayT, ElemT*, jint)>
+struct array_elements_deleter
+{
+	typedef void result_type;
+
+	array_elements_deleter() : env(0), array(0), mode(0) {}
+	array_elements_deleter(JNIEnv* e, ArrayT a, jint m = 0) : env(e), array(a), mode(m) {}
+
+	void operator()(ElemT* p) const
+	{
+		if (p != 0) (env->*ReleaseFunction)(array, p, mode);
+	}
+
+	void commit(ElemT* p) const
+	{
+		if (p != 0) (env->*ReleaseFunction)(array, p, JNI_COMMIT);
+	}
+
+	JNIEnv* env;
+	ArrayT array;
+	jint mode;
+};
+
+typedef array_elements_deleter<jarray, void, &JNIEnv::ReleasePrimitiveArrayCritical> release_primitive_array_critical_deleter;
+
+template<typename T>
+struct primitive_array_traits;
+
+#define KONATA_JNI_PRIMITIVE_ARRAY_TRAITS(Type, type) \
+	template<> \
+	struct primitive_array_traits<type> \
+	{ \
+		typedef type##Array array_type; \
+		typedef array_elements_deleter<type##Array, type, &JNIEnv::Release##Type##ArrayElements> deleter_type; \
+		static type* get_elements(JNIEnv* env, type##Array array, jboolean* isCopy) \
+		{ \
+			return env->Get##Type##ArrayElements(array, isCopy); \
+		} \
+	};
+
+KONATA_JNI_PRIMITIVE_ARRAY_TRAITS(Boolean, jboolean)
+KONATA_JNI_PRIMITIVE_ARRAY_TRAITS(Byte, jbyte)
+KONATA_JNI_PRIMITIVE_ARRAY_TRAITS(Char, jchar)
+KONATA_JNI_PRIMITIVE_ARRAY_TRAITS(Short, jshort)
+KONATA_JNI_PRIMITIVE_ARRAY_TRAITS(Int, jint)
+KONATA_JNI_PRIMITIVE_ARRAY_TRAITS(Long, jlong)
+KONATA_JNI_PRIMITIVE_ARRAY_TRAITS(Float, jfloat)
+KONATA_JNI_PRIMITIVE_ARRAY_TRAITS(Double, jdouble)
+
+#undef KONATA_JNI_PRIMITIVE_ARRAY_TRAITS
+
+} // namespace detail
+
+// unique_ptr over Get<Type>ArrayElements, in the manner of scoped_chars_ptr;
+// e.g. scoped_array_elements_ptr<jbyte>.
+template<typename T>
+using scoped_array_elements_ptr = std::unique_ptr<T[], typename detail::primitive_array_traits<T>::deleter_type>;
+
+template<typename T>
+inline scoped_array_elements_ptr<T> GetArrayElements(
+	JNIEnv* env, typename detail::primitive_array_traits<T>::array_type array, jboolean* isCopy, jint mode = 0)
+{
+	return scoped_array_elements_ptr<T>(
+		detail::primitive_array_traits<T>::get_elements(env, array, isCopy),
+		typename detail::primitive_array_traits<T>::deleter_type(env, array, mode));
+}
+
+// The elements of a Java primitive array, with its length, released on
+// destruction with the mode given at construction. Use JNI_ABORT for
+// read-only access so that a copying VM skips the copy back.
+template<typename T>
+class array_elements
+{
+public:
+	typedef typename detail::primitive_array_traits<T>::array_type array_type;
+	typedef T element_type;
+
+	array_elements(JNIEnv* env, array_type array, jint mode = 0)
+		: m_size(array != 0 ? static_cast<std::size_t>(env->GetArrayLength(array)) : 0), m_isCopy(JNI_FALSE)
+	{
+		if (array != 0)
+			m_elements = GetArrayElements<T>(env, array, &m_isCopy, mode);
+	}
+
+	T* data() const { return m_elements.get(); }
+	std::size_t size() const { return m_size; }
+	bool empty() const { return m_size == 0; }
+	T* begin() const { return data(); }
+	T* end() const { return data() + m_size; }
+	T& operator[](std::size_t i) const { return m_elements[i]; }
+	// Whether the VM handed out a copy; false means writes are in place.
+	bool is_copy() const { return m_isCopy != JNI_FALSE; }
+	// false if the VM could not provide the elements (OutOfMemoryError pending).
+	explicit operator bool() const { return m_elements != nullptr || m_size == 0; }
+
+#ifdef KONATA_JNI_HAS_SPAN
+	std::span<T> span() const { return std::span<T>(data(), m_size); }
+#endif
+
+	// Copies the elements back to the array and keeps them (JNI_COMMIT).
+	void commit()
+	{
+		m_elements.get_deleter().commit(m_elements.get());
+	}
+
+	// Releases now with the given mode (0 or JNI_ABORT).
+	void release(jint mode)
+	{
+		m_elements.get_deleter().mode = mode;
+		m_elements.reset();
+		m_size = 0;
+	}
+
+	void set_release_mode(jint mode) { m_elements.get_deleter().mode = mode; }
+
+private:
+	scoped_array_elements_ptr<T> m_elements;
+	std::size_t m_size;
+	jboolean m_isCopy;
+};
+
+typedef std::unique_ptr<void, detail::release_primitive_array_critical_deleter> scoped_primitive_array_critical_ptr;
+
+inline scoped_primitive_array_critical_ptr GetPrimitiveArrayCritical(JNIEnv* env, jarray array, jboolean* isCopy, jint mode = 0)
+{
+	return scoped_primitive_array_critical_ptr(
+		env->GetPrimitiveArrayCritical(array, isCopy),
+		detail::release_primitive_array_critical_deleter(env, array, mode));
+}
+
+// Like array_elements, through GetPrimitiveArrayCritical: usually no copy,
+// but until destruction the thread must not call other JNI functions or
+// block, and the GC may be held off.
+template<typename T>
+class array_critical
+{
+public:
+	typedef typename detail::primitive_array_traits<T>::array_type array_type;
+	typedef T element_type;
+
+	array_critical(JNIEnv* env, array_type array, jint mode = 0)
+		: m_size(array != 0 ? static_cast<std::size_t>(env->GetArrayLength(array)) : 0), m_isCopy(JNI_FALSE)
+	{
+		if (array != 0)
+			m_elements = GetPrimitiveArrayCritical(env, array, &m_isCopy, mode);
+	}
+
+	T* data() const { return static_cast<T*>(m_elements.get()); }
+	std::size_t size() const { return m_size; }
+	bool empty() const { return m_size == 0; }
+	T* begin() const { return data(); }
+	T* end() const { return data() + m_size; }
+	T& operator[](std::size_t i) const { return data()[i]; }
+	bool is_copy() const { return m_isCopy != JNI_FALSE; }
+	explicit operator bool() const { return m_elements != nullptr || m_size == 0; }
+
+#ifdef KONATA_JNI_HAS_SPAN
+	std::span<T> span() const { return std::span<T>(data(), m_size); }
+#endif
+
+	void commit()
+	{
+		m_elements.get_deleter().commit(m_elements.get());
+	}
+
+	void release(jint mode)
+	{
+		m_elements.get_deleter().mode = mode;
+		m_elements.reset();
+		m_size = 0;
+	}
+
+	void set_release_mode(jint mode) { m_elements.get_deleter().mode = mode; }
+
+private:
+	scoped_primitive_array_critical_ptr m_elements;
+	std::size_t m_size;
+	jboolean m_isCopy;
+};
+
+// The memory behind a direct java.nio.Buffer, viewed as T, for working in
+// place without Get<Type>ArrayRegion copies. Empty if buffer is not a
+// direct buffer or the VM does not support direct buffer access.
+// GetDirectBufferCapacity counts the buffer's own elements, so elementSize
+// is the size of those: 1 for a ByteBuffer, 2 for a CharBuffer or
+// ShortBuffer, 4 for an IntBuffer or FloatBuffer, 8 for a LongBuffer or
+// DoubleBuffer. The memory stays valid as long as the buffer object is
+// reachable.
+template<typename T>
+class direct_buffer
+{
+public:
+	direct_buffer(JNIEnv* env, jobject buffer, std::size_t elementSize = 1)
+		: m_data(static_cast<T*>(env->GetDirectBufferAddress(buffer))), m_size(0)
+	{
+		if (m_data != 0)
+		{
+			jlong capacity = env->GetDirectBufferCapacity(buffer);
+			if (capacity > 0)
+				m_size = static_cast<std::size_t>(static_cast<unsigned long long>(capacity) * elementSize / sizeof(T));
+		}
+	}
+
+	T* data() const { return m_data; }
+	std::size_t size() const { return m_size; }
+	bool empty() const { return m_size == 0; }
+	T* begin() const { return m_data; }
+	T* end() const { return m_data + m_size; }
+	T& operator[](std::size_t i) const { return m_data[i]; }
+	explicit operator bool() const { return m_data != 0; }
+
+#ifdef KONATA_JNI_HAS_SPAN
+	std::span<T> span() const { return std::span<T>(m_data, m_size); }
+#endif
+
+private:
+	T* m_data;
+	std::size_t m_size;
+};
+
+// Wraps native memory in a direct ByteBuffer; the memory must outlive
+// every Java reference to the buffer.
+inline jobject NewDirectByteBuffer(JNIEnv* env, void* data, std::size_t size)
+{
+	return env->NewDirectByteBuffer(data, static_cast<jlong>(size));
+}
+
+} // namespace jni
+} // namespace konata
+
+#endif // KONATA_JNI_ARRAY_HPP
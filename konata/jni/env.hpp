@@ -0,0 +1,193 @@
+// konata/jni/env.hpp
+//
+// Copyright (c) Egtra 2026
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt )
+
+#ifndef KONATA_JNI_ENV_HPP
+#define KONATA_JNI_ENV_HPP
+
+#include <atomic>
+#include <jni.h>
+
+namespace konata
+{
+namespace jni
+{
+
+namespace detail {
+
+inline std::atomic<JavaVM*>& process_java_vm()
+{
+	static std::atomic<JavaVM*> vm(0);
+	return vm;
+}
+
+// The attachment made by this library on the current thread, undone by the
+// thread_local destructor when the thread exits.
+struct thread_attachment
+{
+	thread_attachment() : vm(0), env(0) {}
+
+	~thread_attachment()
+	{
+		detach();
+	}
+
+	void detach()
+	{
+		if (env != 0)
+			vm->DetachCurrentThread();
+		vm = 0;
+		env = 0;
+	}
+
+	JavaVM* vm;
+	JNIEnv* env;
+};
+
+inline thread_attachment& current_thread_attachment()
+{
+	thread_local thread_attachment attachment;
+	return attachment;
+}
+
+inline jint attach(JavaVM* vm, JNIEnv** env, JavaVMAttachArgs* args, bool daemon)
+{
+#ifdef __ANDROID__
+	// The NDK declares these with JNIEnv** rather than void**.
+	return daemon ? vm->AttachCurrentThreadAsDaemon(env, args) : vm->AttachCurrentThread(env, args);
+#else
+	return daemon
+		? vm->AttachCurrentThreadAsDaemon(reinterpret_cast<void**>(env), args)
+		: vm->AttachCurrentThread(reinterpret_cast<void**>(env), args);
+#endif
+}
+
+} // namespace detail
+
+// The JavaVM used by current_env and thread_env; set it in JNI_OnLoad.
+inline void set_java_vm(JavaVM* vm)
+{
+	detail::process_java_vm().store(vm, std::memory_order_release);
+}
+
+inline JavaVM* java_vm()
+{
+	return detail::process_java_vm().load(std::memory_order_acquire);
+}
+
+// The JNIEnv of the current thread. A thread the VM does not know yet is
+// attached (as a daemon if requested, so that it does not keep the VM
+// from shutting down) the first time, and detached when it exits; later
+// calls return the env cached in a thread_local. Threads that were
+// already attached, such as Java threads, are left as they are.
+// Returns 0 if the thread cannot be attached.
+inline JNIEnv* attach_current_thread(JavaVM* vm, bool daemon = false, const char* threadName = 0, jobject threadGroup = 0)
+{
+	detail::thread_attachment& attachment = detail::current_thread_attachment();
+	if (attachment.env != 0 && attachment.vm == vm)
+		return attachment.env;
+
+	JNIEnv* env = 0;
+	jint rc = vm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6);
+	if (rc == JNI_OK)
+		return env;
+	if (rc != JNI_EDETACHED)
+		return 0;
+
+	JavaVMAttachArgs args;
+	args.version = JNI_VERSION_1_6;
+	args.name = const_cast<char*>(threadName);
+	args.group = threadGroup;
+	if (detail::attach(vm, &env, &args, daemon) != JNI_OK)
+		return 0;
+	attachment.detach();
+	attachment.vm = vm;
+	attachment.env = env;
+	return env;
+}
+
+// attach_current_thread with the VM given to set_java_vm.
+inline JNIEnv* current_env(bool daemon = false)
+{
+	JavaVM* vm = java_vm();
+	return vm != 0 ? attach_current_thread(vm, daemon) : 0;
+}
+
+// Detaches the current thread now if attach_current_thread attached it;
+// local references and envs obtained on it become invalid.
+inline void detach_current_thread()
+{
+	detail::current_thread_attachment().detach();
+}
+
+// The env of the current thread as an object: converts to JNIEnv*, so it
+// can be passed wherever one is taken (GetStringChars, GetArrayElements,
+// array_elements, ...), and the scoped pointers made from it stay valid
+// until the thread exits.
+class thread_env
+{
+public:
+	explicit thread_env(bool daemon = false) : m_env(current_env(daemon)) {}
+	explicit thread_env(JavaVM* vm, bool daemon = false) : m_env(attach_current_thread(vm, daemon)) {}
+
+	JNIEnv* get() const { return m_env; }
+	operator JNIEnv*() const { return m_env; }
+	JNIEnv* operator->() const { return m_env; }
+	explicit operator bool() const { return m_env != 0; }
+
+private:
+	JNIEnv* m_env;
+};
+
+// A local reference frame (PushLocalFrame/PopLocalFrame): local references
+// created while it lives are freed together when it ends, so that a long
+// loop does not fill up the local reference table.
+//   for (...)
+//   {
+//       local_frame frame(env, 16);
+//       ...
+//   }
+class local_frame
+{
+public:
+	local_frame(JNIEnv* env, jint capacity)
+		: m_env(env), m_pushed(env->PushLocalFrame(capacity) == JNI_OK)
+	{
+	}
+
+	~local_frame()
+	{
+		if (m_pushed)
+			m_env->PopLocalFrame(0);
+	}
+
+	// false, with OutOfMemoryError pending, if the frame could not be pushed.
+	explicit operator bool() const { return m_pushed; }
+
+	// Ends the frame now and returns result as a local reference in the
+	// enclosing frame.
+	template<typename T>
+	T pop(T result)
+	{
+		if (!m_pushed)
+			return result;
+		m_pushed = false;
+		return static_cast<T>(m_env->PopLocalFrame(result));
+	}
+
+private:
+	local_frame(local_frame const&);
+	local_frame& operator=(local_frame const&);
+
+	JNIEnv* m_env;
+	bool m_pushed;
+};
+
+} // namespace jni
+} // namespace konata
+
+#endif // KONATA_JNI_ENV_HPP
@@ -0,0 +1,93 @@
+// konata/jni/java_vm.hpp
+//
+// Copyright (c) Egtra 2026
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt )
+
+#ifndef KONATA_JNI_JAVA_VM_HPP
+#define KONATA_JNI_JAVA_VM_HPP
+
+#include <string>
+#include <vector>
+#include <jni.h>
+
+#include <konata/jni/env.hpp>
+
+namespace konata
+{
+namespace jni
+{
+
+// A JVM started inside this process with JNI_CreateJavaVM (link with
+// libjvm), for native programs and test drivers that host Java rather
+// than being loaded by it. The options are those of the java launcher,
+// e.g. "-Djava.class.path=classes" or "-Xcheck:jni". The creating thread
+// stays attached; on success the VM also becomes the one current_env()
+// uses. A process can create only one VM.
+//
+// The destructor calls DestroyJavaVM, which waits for every non-daemon
+// thread, so threads attached through attach_current_thread must have
+// exited or called detach_current_thread by then.
+class embedded_java_vm
+{
+public:
+	explicit embedded_java_vm(const std::vector<std::string>& options, jint version = JNI_VERSION_1_6, bool ignoreUnrecognized = false)
+		: m_vm(0), m_env(0), m_result(JNI_ERR)
+	{
+		std::vector<JavaVMOption> vmOptions(options.size());
+		for (std::size_t i = 0; i < options.size(); ++i)
+		{
+			vmOptions[i].optionString = const_cast<char*>(options[i].c_str());
+			vmOptions[i].extraInfo = 0;
+		}
+		JavaVMInitArgs args;
+		args.version = version;
+		args.nOptions = static_cast<jint>(vmOptions.size());
+		args.options = vmOptions.empty() ? 0 : &vmOptions[0];
+		args.ignoreUnrecognized = ignoreUnrecognized ? JNI_TRUE : JNI_FALSE;
+
+		JNIEnv* env = 0;
+		m_result = JNI_CreateJavaVM(&m_vm, reinterpret_cast<void**>(&env), &args);
+		if (m_result == JNI_OK)
+		{
+			m_env = env;
+			set_java_vm(m_vm);
+		}
+		else
+		{
+			m_vm = 0;
+		}
+	}
+
+	~embedded_java_vm()
+	{
+		if (m_vm != 0)
+		{
+			if (java_vm() == m_vm)
+				set_java_vm(0);
+			m_vm->DestroyJavaVM();
+		}
+	}
+
+	JavaVM* get() const { return m_vm; }
+	// The env of the thread that created the VM.
+	JNIEnv* env() const { return m_env; }
+	// The result of JNI_CreateJavaVM: JNI_OK, or e.g. JNI_EVERSION, JNI_EINVAL, JNI_EEXIST.
+	jint result() const { return m_result; }
+	explicit operator bool() const { return m_vm != 0; }
+
+private:
+	embedded_java_vm(embedded_java_vm const&);
+	embedded_java_vm& operator=(embedded_java_vm const&);
+
+	JavaVM* m_vm;
+	JNIEnv* m_env;
+	jint m_result;
+};
+
+} // namespace jni
+} // namespace konata
+
+#endif // KONATA_JNI_JAVA_VM_HPP
@@ -0,0 +1,459 @@
+// konata/jni/registry.hpp
+//
+// Copyright (c) Egtra 2026
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt )
+
+#ifndef KONATA_JNI_REGISTRY_HPP
+#define KONATA_JNI_REGISTRY_HPP
+
+#include <atomic>
+#include <mutex>
+#include <jni.h>
+
+#include <konata/jni/signature.hpp>
+
+namespace konata
+{
+namespace jni
+{
+
+namespace detail {
+
+// Every java_class, method and field object is linked into one list so
+// that resolve_ids and release_ids reach them all.
+class registered_id
+{
+public:
+	virtual bool resolve(JNIEnv* env) = 0;
+	virtual void release(JNIEnv* env) = 0;
+
+	static std::mutex& registry_mutex()
+	{
+		static std::mutex m;
+		return m;
+	}
+
+	static registered_id*& registry_head()
+	{
+		static registered_id* head = 0;
+		return head;
+	}
+
+protected:
+	registered_id() : m_next(0)
+	{
+		std::lock_guard<std::mutex> lock(registry_mutex());
+		m_next = registry_head();
+		registry_head() = this;
+	}
+
+	~registered_id()
+	{
+		std::lock_guard<std::mutex> lock(registry_mutex());
+		for (registered_id** p = &registry_head(); *p != 0; p = &(*p)->m_next)
+		{
+			if (*p == this)
+			{
+				*p = m_next;
+				break;
+			}
+		}
+	}
+
+private:
+	registered_id(registered_id const&);
+	registered_id& operator=(registered_id const&);
+
+	friend bool resolve_registered_ids(JNIEnv* env);
+	friend void release_registered_ids(JNIEnv* env);
+
+	registered_id* m_next;
+};
+
+inline bool resolve_registered_ids(JNIEnv* env)
+{
+	std::lock_guard<std::mutex> lock(registered_id::registry_mutex());
+	for (registered_id* p = registered_id::registry_head(); p != 0; p = p->m_next)
+	{
+		if (!p->resolve(env))
+			return false;
+	}
+	return true;
+}
+
+inline void release_registered_ids(JNIEnv* env)
+{
+	std::lock_guard<std::mutex> lock(registered_id::registry_mutex());
+	for (registered_id* p = registered_id::registry_head(); p != 0; p = p->m_next)
+		p->release(env);
+}
+
+inline jvalue to_jvalue(jboolean v) { jvalue x; x.z = v; return x; }
+inline jvalue to_jvalue(jbyte v) { jvalue x; x.b = v; return x; }
+inline jvalue to_jvalue(jchar v) { jvalue x; x.c = v; return x; }
+inline jvalue to_jvalue(jshort v) { jvalue x; x.s = v; return x; }
+inline jvalue to_jvalue(jint v) { jvalue x; x.i = v; return x; }
+inline jvalue to_jvalue(jlong v) { jvalue x; x.j = v; return x; }
+inline jvalue to_jvalue(jfloat v) { jvalue x; x.f = v; return x; }
+inline jvalue to_jvalue(jdouble v) { jvalue x; x.d = v; return x; }
+inline jvalue to_jvalue(jobject v) { jvalue x; x.l = v; return x; }
+
+// Dispatches to the Call<Type>Method family by the type T; the primary
+// template covers the jobject family and object_ref.
+template<typename T>
+struct call_traits
+{
+	static T call(JNIEnv* env, jobject obj, jmethodID id, const jvalue* args)
+	{
+		return static_cast<T>(env->CallObjectMethodA(obj, id, args));
+	}
+
+	static T call_static(JNIEnv* env, jclass cls, jmethodID id, const jvalue* args)
+	{
+		return static_cast<T>(env->CallStaticObjectMethodA(cls, id, args));
+	}
+
+	static T call_nonvirtual(JNIEnv* env, jobject obj, jclass cls, jmethodID id, const jvalue* args)
+	{
+		return static_cast<T>(env->CallNonvirtualObjectMethodA(obj, cls, id, args));
+	}
+
+	static T get_field(JNIEnv* env, jobject obj, jfieldID id)
+	{
+		return static_cast<T>(env->GetObjectField(obj, id));
+	}
+
+	static void set_field(JNIEnv* env, jobject obj, jfieldID id, T value)
+	{
+		env->SetObjectField(obj, id, value);
+	}
+
+	static T get_static_field(JNIEnv* env, jclass cls, jfieldID id)
+	{
+		return static_cast<T>(env->GetStaticObjectField(cls, id));
+	}
+
+	static void set_static_field(JNIEnv* env, jclass cls, jfieldID id, T value)
+	{
+		env->SetStaticObjectField(cls, id, value);
+	}
+};
+
+template<>
+struct call_traits<void>
+{
+	static void call(JNIEnv* env, jobject obj, jmethodID id, const jvalue* args)
+	{
+		env->CallVoidMethodA(obj, id, args);
+	}
+
+	static void call_static(JNIEnv* env, jclass cls, jmethodID id, const jvalue* args)
+	{
+		env->CallStaticVoidMethodA(cls, id, args);
+	}
+
+	static void call_nonvirtual(JNIEnv* env, jobject obj, jclass cls, jmethodID id, const jvalue* args)
+	{
+		env->CallNonvirtualVoidMethodA(obj, cls, id, args);
+	}
+};
+
+#define KONATA_JNI_CALL_TRAITS(Type, type) \
+	template<> \
+	struct call_traits<type> \
+	{ \
+		static type call(JNIEnv* env, jobject obj, jmethodID id, const jvalue* args) \
+		{ \
+			return env->Call##Type##MethodA(obj, id, args); \
+		} \
+		static type call_static(JNIEnv* env, jclass cls, jmethodID id, const jvalue* args) \
+		{ \
+			return env->CallStatic##Type##MethodA(cls, id, args); \
+		} \
+		static type call_nonvirtual(JNIEnv* env, jobject obj, jclass cls, jmethodID id, const jvalue* args) \
+		{ \
+			return env->CallNonvirtual##Type##MethodA(obj, cls, id, args); \
+		} \
+		static type get_field(JNIEnv* env, jobject obj, jfieldID id) \
+		{ \
+			return env->Get##Type##Field(obj, id); \
+		} \
+		static void set_field(JNIEnv* env, jobject obj, jfieldID id, type value) \
+		{ \
+			env->Set##Type##Field(obj, id, value); \
+		} \
+		static type get_static_field(JNIEnv* env, jclass cls, jfieldID id) \
+		{ \
+			return env->GetStatic##Type##Field(cls, id); \
+		} \
+		static void set_static_field(JNIEnv* env, jclass cls, jfieldID id, type value) \
+		{ \
+			env->SetStatic##Type##Field(cls, id, value); \
+		} \
+	};
+
+KONATA_JNI_CALL_TRAITS(Boolean, jboolean)
+KONATA_JNI_CALL_TRAITS(Byte, jbyte)
+KONATA_JNI_CALL_TRAITS(Char, jchar)
+KONATA_JNI_CALL_TRAITS(Short, jshort)
+KONATA_JNI_CALL_TRAITS(Int, jint)
+KONATA_JNI_CALL_TRAITS(Long, jlong)
+KONATA_JNI_CALL_TRAITS(Float, jfloat)
+KONATA_JNI_CALL_TRAITS(Double, jdouble)
+
+#undef KONATA_JNI_CALL_TRAITS
+
+} // namespace detail
+
+// Resolves every java_class, method and field declared so far; call it
+// from JNI_OnLoad, where FindClass sees the library's class loader (on a
+// thread attached later, it only sees the system class loader). Returns
+// false, with the exception pending, if a lookup fails.
+inline bool resolve_ids(JNIEnv* env)
+{
+	return detail::resolve_registered_ids(env);
+}
+
+// Deletes the global class references and forgets every ID; for
+// JNI_OnUnload. Later uses resolve again.
+inline void release_ids(JNIEnv* env)
+{
+	detail::release_registered_ids(env);
+}
+
+// A class looked up once by its binary name ("java/lang/String") and held
+// by a global reference. Declare it with static storage duration.
+class java_class : private detail::registered_id
+{
+public:
+	explicit java_class(const char* name) : m_name(name), m_class(0) {}
+
+	const char* name() const { return m_name; }
+
+	// 0, with NoClassDefFoundError pending, if the class is not found.
+	jclass get(JNIEnv* env)
+	{
+		jclass cls = m_class.load(std::memory_order_acquire);
+		if (cls != 0)
+			return cls;
+		jclass local = env->FindClass(m_name);
+		if (local == 0)
+			return 0;
+		jclass global = static_cast<jclass>(env->NewGlobalRef(local));
+		env->DeleteLocalRef(local);
+		if (global == 0)
+			return 0;
+		if (!m_class.compare_exchange_strong(cls, global, std::memory_order_acq_rel, std::memory_order_acquire))
+		{
+			// Another thread resolved it first.
+			env->DeleteGlobalRef(global);
+			return cls;
+		}
+		return global;
+	}
+
+private:
+	virtual bool resolve(JNIEnv* env)
+	{
+		return get(env) != 0;
+	}
+
+	virtual void release(JNIEnv* env)
+	{
+		jclass cls = m_class.exchange(0, std::memory_order_acq_rel);
+		if (cls != 0)
+			env->DeleteGlobalRef(cls);
+	}
+
+	const char* m_name;
+	std::atomic<jclass> m_class;
+};
+
+namespace detail {
+
+// The state shared by method and field objects: the ID, looked up with
+// Lookup on first use.
+template<typename ID, ID (JNIEnv::*Lookup)(jclass, const char*, const char*)>
+class member_id : private registered_id
+{
+public:
+	member_id(java_class& cls, const char* name, const char* signature)
+		: m_class(&cls), m_name(name), m_signature(signature), m_id(0)
+	{
+	}
+
+	java_class& owner() const { return *m_class; }
+	const char* name() const { return m_name; }
+	const char* signature() const { return m_signature; }
+
+	// 0, with NoSuchMethodError/NoSuchFieldError pending, on failure.
+	ID id(JNIEnv* env)
+	{
+		ID result = m_id.load(std::memory_order_acquire);
+		if (result != 0)
+			return result;
+		jclass cls = m_class->get(env);
+		if (cls == 0)
+			return 0;
+		result = (env->*Lookup)(cls, m_name, m_signature);
+		// IDs are stable for the life of the class; a racing store writes the same value.
+		if (result != 0)
+			m_id.store(result, std::memory_order_release);
+		return result;
+	}
+
+private:
+	virtual bool resolve(JNIEnv* env)
+	{
+		return id(env) != 0;
+	}
+
+	virtual void release(JNIEnv*)
+	{
+		m_id.store(0, std::memory_order_release);
+	}
+
+	java_class* m_class;
+	const char* m_name;
+	const char* m_signature;
+	std::atomic<ID> m_id;
+};
+
+} // namespace detail
+
+// An instance method, its signature derived from F, e.g.
+//   static java_class list("java/util/List");
+//   static method<jboolean(jobject)> list_add(list, "add");
+//   list_add(env, obj, item);
+// If the lookup fails, a call returns R() with the exception pending.
+template<typename F>
+class method;
+
+template<typename R, typename... Args>
+class method<R(Args...)> : public detail::member_id<jmethodID, &JNIEnv::GetMethodID>
+{
+public:
+	method(java_class& cls, const char* name)
+		: detail::member_id<jmethodID, &JNIEnv::GetMethodID>(cls, name, method_signature<R(Args...)>::value)
+	{
+	}
+
+	R operator()(JNIEnv* env, jobject obj, Args... args)
+	{
+		jmethodID m = id(env);
+		if (m == 0)
+			return R();
+		jvalue values[sizeof...(Args) + 1] = {detail::to_jvalue(args)...};
+		return detail::call_traits<R>::call(env, obj, m, values);
+	}
+
+	// Calls this class's implementation, bypassing overrides (super.name()).
+	R call_nonvirtual(JNIEnv* env, jobject obj, Args... args)
+	{
+		jmethodID m = id(env);
+		if (m == 0)
+			return R();
+		jvalue values[sizeof...(Args) + 1] = {detail::to_jvalue(args)...};
+		return detail::call_traits<R>::call_nonvirtual(env, obj, owner().get(env), m, values);
+	}
+};
+
+template<typename F>
+class static_method;
+
+template<typename R, typename... Args>
+class static_method<R(Args...)> : public detail::member_id<jmethodID, &JNIEnv::GetStaticMethodID>
+{
+public:
+	static_method(java_class& cls, const char* name)
+		: detail::member_id<jmethodID, &JNIEnv::GetStaticMethodID>(cls, name, method_signature<R(Args...)>::value)
+	{
+	}
+
+	R operator()(JNIEnv* env, Args... args)
+	{
+		jmethodID m = id(env);
+		if (m == 0)
+			return R();
+		jvalue values[sizeof...(Args) + 1] = {detail::to_jvalue(args)...};
+		return detail::call_traits<R>::call_static(env, owner().get(env), m, values);
+	}
+};
+
+// A constructor, F being void(Args...); a call returns the new local
+// reference, or 0 with the exception pending.
+template<typename F>
+class constructor;
+
+template<typename... Args>
+class constructor<void(Args...)> : public detail::member_id<jmethodID, &JNIEnv::GetMethodID>
+{
+public:
+	explicit constructor(java_class& cls)
+		: detail::member_id<jmethodID, &JNIEnv::GetMethodID>(cls, "<init>", method_signature<void(Args...)>::value)
+	{
+	}
+
+	jobject operator()(JNIEnv* env, Args... args)
+	{
+		jmethodID m = id(env);
+		if (m == 0)
+			return 0;
+		jvalue values[sizeof...(Args) + 1] = {detail::to_jvalue(args)...};
+		return env->NewObjectA(owner().get(env), m, values);
+	}
+};
+
+template<typename T>
+class field : public detail::member_id<jfieldID, &JNIEnv::GetFieldID>
+{
+public:
+	field(java_class& cls, const char* name)
+		: detail::member_id<jfieldID, &JNIEnv::GetFieldID>(cls, name, type_signature<T>::value)
+	{
+	}
+
+	T get(JNIEnv* env, jobject obj)
+	{
+		jfieldID f = id(env);
+		return f != 0 ? detail::call_traits<T>::get_field(env, obj, f) : T();
+	}
+
+	void set(JNIEnv* env, jobject obj, T value)
+	{
+		jfieldID f = id(env);
+		if (f != 0)
+			detail::call_traits<T>::set_field(env, obj, f, value);
+	}
+};
+
+template<typename T>
+class static_field : public detail::member_id<jfieldID, &JNIEnv::GetStaticFieldID>
+{
+public:
+	static_field(java_class& cls, const char* name)
+		: detail::member_id<jfieldID, &JNIEnv::GetStaticFieldID>(cls, name, type_signature<T>::value)
+	{
+	}
+
+	T get(JNIEnv* env)
+	{
+		jfieldID f = id(env);
+		return f != 0 ? detail::call_traits<T>::get_static_field(env, owner().get(env), f) : T();
+	}
+
+	void set(JNIEnv* env, T value)
+	{
+		jfieldID f = id(env);
+		if (f != 0)
+			detail::call_traits<T>::set_static_field(env, owner().get(env), f, value);
+	}
+};
+
+} // namespace jni
+} // namespace konata
+
+#endif // KONATA_JNI_REGISTRY_HPP
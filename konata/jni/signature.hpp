@@ -0,0 +1,166 @@
+// konata/jni/signature.hpp
+//
+// Copyright (c) Egtra 2026
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt )
+
+#ifndef KONATA_JNI_SIGNATURE_HPP
+#define KONATA_JNI_SIGNATURE_HPP
+
+#include <cstddef>
+#include <jni.h>
+
+namespace konata
+{
+namespace jni
+{
+
+// A type descriptor spelled as a character pack; value is the NUL
+// terminated string, built by the compiler.
+template<char... C>
+struct signature_string
+{
+	typedef signature_string type;
+	static const char value[sizeof...(C) + 1];
+};
+
+template<char... C>
+const char signature_string<C...>::value[sizeof...(C) + 1] = {C..., '\0'};
+
+namespace detail {
+
+template<typename... S>
+struct concat_signatures;
+
+template<>
+struct concat_signatures<>
+{
+	typedef signature_string<> type;
+};
+
+template<char... A>
+struct concat_signatures<signature_string<A...>>
+{
+	typedef signature_string<A...> type;
+};
+
+template<char... A, char... B, typename... Rest>
+struct concat_signatures<signature_string<A...>, signature_string<B...>, Rest...>
+	: concat_signatures<signature_string<A..., B...>, Rest...>
+{
+};
+
+template<std::size_t... I>
+struct index_sequence {};
+
+template<std::size_t N, std::size_t... I>
+struct make_index_sequence : make_index_sequence<N - 1, N - 1, I...> {};
+
+template<std::size_t... I>
+struct make_index_sequence<0, I...>
+{
+	typedef index_sequence<I...> type;
+};
+
+template<typename Tag, typename Indices>
+struct class_name_chars;
+
+template<typename Tag, std::size_t... I>
+struct class_name_chars<Tag, index_sequence<I...>>
+{
+	typedef signature_string<Tag::class_name[I]...> type;
+};
+
+typedef signature_string<'j', 'a', 'v', 'a', '/', 'l', 'a', 'n', 'g', '/'> java_lang;
+
+template<typename Name>
+struct java_lang_object
+	: concat_signatures<signature_string<'L'>, java_lang, Name, signature_string<';'>>::type
+{
+};
+
+} // namespace detail
+
+// "Lclass/name;" for a tag type with a member
+// static constexpr char class_name[] = "class/name";
+template<typename Tag>
+struct class_signature
+	: detail::concat_signatures<
+		signature_string<'L'>,
+		typename detail::class_name_chars<Tag, typename detail::make_index_sequence<sizeof(Tag::class_name) - 1>::type>::type,
+		signature_string<';'>>::type
+{
+};
+
+// A jobject known to be an instance of the class named by Tag, so that
+// its type descriptor is part of the signatures built from it.
+template<typename Tag>
+class object_ref
+{
+public:
+	object_ref() : m_object(0) {}
+	explicit object_ref(jobject obj) : m_object(obj) {}
+
+	jobject get() const { return m_object; }
+	operator jobject() const { return m_object; }
+
+private:
+	jobject m_object;
+};
+
+// The type descriptor of T: the primitive types, void, the jobject
+// family and object_ref. Specialize it, deriving from a signature_string,
+// for other types passed to or returned from Java.
+template<typename T>
+struct type_signature;
+
+template<> struct type_signature<void> : signature_string<'V'> {};
+template<> struct type_signature<jboolean> : signature_string<'Z'> {};
+template<> struct type_signature<jbyte> : signature_string<'B'> {};
+template<> struct type_signature<jchar> : signature_string<'C'> {};
+template<> struct type_signature<jshort> : signature_string<'S'> {};
+template<> struct type_signature<jint> : signature_string<'I'> {};
+template<> struct type_signature<jlong> : signature_string<'J'> {};
+template<> struct type_signature<jfloat> : signature_string<'F'> {};
+template<> struct type_signature<jdouble> : signature_string<'D'> {};
+
+template<> struct type_signature<jobject> : detail::java_lang_object<signature_string<'O', 'b', 'j', 'e', 'c', 't'>> {};
+template<> struct type_signature<jclass> : detail::java_lang_object<signature_string<'C', 'l', 'a', 's', 's'>> {};
+template<> struct type_signature<jstring> : detail::java_lang_object<signature_string<'S', 't', 'r', 'i', 'n', 'g'>> {};
+template<> struct type_signature<jthrowable> : detail::java_lang_object<signature_string<'T', 'h', 'r', 'o', 'w', 'a', 'b', 'l', 'e'>> {};
+
+template<> struct type_signature<jbooleanArray> : signature_string<'[', 'Z'> {};
+template<> struct type_signature<jbyteArray> : signature_string<'[', 'B'> {};
+template<> struct type_signature<jcharArray> : signature_string<'[', 'C'> {};
+template<> struct type_signature<jshortArray> : signature_string<'[', 'S'> {};
+template<> struct type_signature<jintArray> : signature_string<'[', 'I'> {};
+template<> struct type_signature<jlongArray> : signature_string<'[', 'J'> {};
+template<> struct type_signature<jfloatArray> : signature_string<'[', 'F'> {};
+template<> struct type_signature<jdoubleArray> : signature_string<'[', 'D'> {};
+template<> struct type_signature<jobjectArray>
+	: detail::concat_signatures<signature_string<'['>, type_signature<jobject>::type>::type {};
+
+template<typename Tag>
+struct type_signature<object_ref<Tag>> : class_signature<Tag> {};
+
+// The method descriptor of a function type, e.g.
+// method_signature<void(jint, jstring)>::value is "(ILjava/lang/String;)V".
+template<typename F>
+struct method_signature;
+
+template<typename R, typename... Args>
+struct method_signature<R(Args...)>
+	: detail::concat_signatures<
+		signature_string<'('>,
+		typename type_signature<Args>::type...,
+		signature_string<')'>,
+		typename type_signature<R>::type>::type
+{
+};
+
+} // namespace jni
+} // namespace konata
+
+#endif // KONATA_JNI_SIGNATURE_HPP
@@ -59,7 +59,7 @@ inline scoped_chars_ptr GetStringChars(JNIEnv* env, jstring str, jboolean* isCop
 
 typedef std::unique_ptr<const char[], detail::release_string_utf_chars_deleter> scoped_utf_chars_ptr;
 
-scoped_utf_chars_ptr GetStringUTFChars(JNIEnv* env, jstring str, jboolean* isCopy)
+inline scoped_utf_chars_ptr GetStringUTFChars(JNIEnv* env, jstring str, jboolean* isCopy)
 {
 	return scoped_utf_chars_ptr(
 		env->GetStringUTFChars(str, isCopy),
@@ -78,4 +78,4 @@ inline scoped_critical_ptr GetStringCritical(JNIEnv* env, jstring str, jboolean*
 } // namespace jni
 } // namspace konata
 
-#endif KONATA_JNI_STRING_HPP
+#endif // KONATA_JNI_STRING_HPP
@@ -0,0 +1,209 @@
+// konata/jni/string_array.hpp
+//
+// Copyright (c) Egtra 2026
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt )
+
+#ifndef KONATA_JNI_STRING_ARRAY_HPP
+#define KONATA_JNI_STRING_ARRAY_HPP
+
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <vector>
+#include <jni.h>
+
+#include <konata/jni/env.hpp>
+#include <konata/jni/registry.hpp>
+#include <konata/jni/transcode.hpp>
+
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#include <string_view>
+#define KONATA_JNI_HAS_STRING_VIEW
+#endif
+
+namespace konata
+{
+namespace jni
+{
+
+namespace detail {
+
+inline java_class& string_class()
+{
+	static java_class cls("java/lang/String");
+	return cls;
+}
+
+} // namespace detail
+
+// The elements of a String[] as standard UTF-8, packed into one buffer
+// one after another, each NUL terminated: element i starts at offsets()[i]
+// and ends before offsets()[i + 1] - 1. Each element is copied straight
+// into the buffer with GetStringUTFRegion, and the local references are
+// dropped a chunk at a time through a local_frame. Reusing one object
+// with assign() also reuses its buffer.
+class utf8_string_arena
+{
+public:
+	utf8_string_arena() : m_capacity(0), m_used(0) {}
+
+	utf8_string_arena(JNIEnv* env, jobjectArray array, jsize chunkSize = 256) : m_capacity(0), m_used(0)
+	{
+		assign(env, array, chunkSize);
+	}
+
+	// Replaces the contents with the elements of array; null elements
+	// become empty strings. Returns false, with OutOfMemoryError pending,
+	// if a local frame cannot be pushed; the elements read so far remain.
+	bool assign(JNIEnv* env, jobjectArray array, jsize chunkSize = 256)
+	{
+		clear();
+		jsize n = array != 0 ? env->GetArrayLength(array) : 0;
+		if (chunkSize <= 0)
+			chunkSize = 1;
+		m_offsets.reserve(static_cast<std::size_t>(n) + 1);
+		for (jsize begin = 0; begin < n; )
+		{
+			jsize count = n - begin < chunkSize ? n - begin : chunkSize;
+			local_frame frame(env, count);
+			if (!frame)
+				return false;
+			for (jsize end = begin + count; begin < end; ++begin)
+				append(env, static_cast<jstring>(env->GetObjectArrayElement(array, begin)));
+		}
+		return true;
+	}
+
+	void clear()
+	{
+		m_used = 0;
+		m_offsets.assign(1, 0);
+	}
+
+	std::size_t size() const { return m_offsets.empty() ? 0 : m_offsets.size() - 1; }
+	bool empty() const { return size() == 0; }
+
+	const char* data(std::size_t i) const { return m_bytes.get() + m_offsets[i]; }
+	std::size_t length(std::size_t i) const { return m_offsets[i + 1] - m_offsets[i] - 1; }
+
+	// The whole arena: byte_size() bytes, indexed by offsets().
+	const char* bytes() const { return m_bytes.get(); }
+	std::size_t byte_size() const { return m_used; }
+	const std::vector<std::size_t>& offsets() const { return m_offsets; }
+
+#ifdef KONATA_JNI_HAS_STRING_VIEW
+	std::string_view operator[](std::size_t i) const
+	{
+		return std::string_view(data(i), length(i));
+	}
+
+	// Views into the arena, valid until it is modified or destroyed.
+	std::vector<std::string_view> views() const
+	{
+		std::vector<std::string_view> result;
+		result.reserve(size());
+		for (std::size_t i = 0; i < size(); ++i)
+			result.push_back((*this)[i]);
+		return result;
+	}
+#endif
+
+private:
+	utf8_string_arena(utf8_string_arena const&);
+	utf8_string_arena& operator=(utf8_string_arena const&);
+
+	void append(JNIEnv* env, jstring str)
+	{
+		std::size_t n = 0;
+		if (str != 0)
+		{
+			jsize length = env->GetStringLength(str);
+			std::size_t modifiedLength = static_cast<std::size_t>(env->GetStringUTFLength(str));
+			char* out = reserve(modifiedLength + 1);
+			env->GetStringUTFRegion(str, 0, length, out);
+			n = modifiedLength;
+			// One byte per char means ASCII without NUL, which needs no rewriting.
+			if (modifiedLength != static_cast<std::size_t>(length))
+				n = modified_utf8_to_utf8(out, modifiedLength, out);
+		}
+		else
+		{
+			reserve(1);
+		}
+		m_bytes[m_used + n] = '\0';
+		m_used += n + 1;
+		m_offsets.push_back(m_used);
+	}
+
+	char* reserve(std::size_t n)
+	{
+		if (m_capacity - m_used < n)
+		{
+			std::size_t capacity = m_capacity * 2;
+			if (capacity < m_used + n)
+				capacity = m_used + n;
+			if (capacity < 4096)
+				capacity = 4096;
+			std::unique_ptr<char[]> bytes(new char[capacity]);
+			if (m_used > 0)
+				std::memcpy(bytes.get(), m_bytes.get(), m_used);
+			m_bytes.swap(bytes);
+			m_capacity = capacity;
+		}
+		return m_bytes.get() + m_used;
+	}
+
+	std::unique_ptr<char[]> m_bytes;
+	std::size_t m_capacity;
+	std::size_t m_used;
+	std::vector<std::size_t> m_offsets;
+};
+
+// Builds a String[] from the standard UTF-8 strings in [first, last),
+// whose elements have data() and size() (std::string_view, std::string).
+// Returns 0, with the exception pending, on failure.
+template<typename ForwardIterator>
+jobjectArray NewStringArray(JNIEnv* env, ForwardIterator first, ForwardIterator last)
+{
+	jclass stringClass = detail::string_class().get(env);
+	if (stringClass == 0)
+		return 0;
+	jsize count = static_cast<jsize>(std::distance(first, last));
+	jobjectArray array = env->NewObjectArray(count, stringClass, 0);
+	if (array == 0)
+		return 0;
+
+	std::vector<char> buffer;
+	for (jsize i = 0; first != last; ++first, ++i)
+	{
+		std::size_t n = first->size();
+		if (buffer.size() < 3 * n + 1)
+			buffer.resize(3 * n + 1);
+		std::size_t m = utf8_to_modified_utf8(first->data(), n, buffer.data());
+		buffer[m] = '\0';
+		jstring str = env->NewStringUTF(buffer.data());
+		if (str == 0)
+		{
+			env->DeleteLocalRef(array);
+			return 0;
+		}
+		env->SetObjectArrayElement(array, i, str);
+		env->DeleteLocalRef(str);
+	}
+	return array;
+}
+
+template<typename Container>
+jobjectArray NewStringArray(JNIEnv* env, const Container& strings)
+{
+	return NewStringArray(env, strings.begin(), strings.end());
+}
+
+} // namespace jni
+} // namespace konata
+
+#endif // KONATA_JNI_STRING_ARRAY_HPP
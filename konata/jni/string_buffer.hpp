@@ -0,0 +1,185 @@
+// konata/jni/string_buffer.hpp
+//
+// Copyright (c) Egtra 2026
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt )
+
+#ifndef KONATA_JNI_STRING_BUFFER_HPP
+#define KONATA_JNI_STRING_BUFFER_HPP
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <jni.h>
+
+#include <konata/jni/transcode.hpp>
+
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#include <string_view>
+#define KONATA_JNI_HAS_STRING_VIEW
+#endif
+
+namespace konata
+{
+namespace jni
+{
+
+// Copies str as UTF-16 into buffer with GetStringRegion and returns its
+// length. If the length exceeds capacity, nothing is copied.
+inline jsize copy_string_utf16(JNIEnv* env, jstring str, jchar* buffer, jsize capacity)
+{
+	jsize length = env->GetStringLength(str);
+	if (length <= capacity && length > 0)
+		env->GetStringRegion(str, 0, length, buffer);
+	return length;
+}
+
+// Copies str as standard UTF-8 into buffer with GetStringUTFRegion, NUL
+// terminated, and returns the number of bytes before the NUL. If that
+// does not fit, nothing is copied and the return value, greater than
+// capacity, is the capacity needed.
+inline std::size_t copy_string_utf8(JNIEnv* env, jstring str, char* buffer, std::size_t capacity)
+{
+	jsize length = env->GetStringLength(str);
+	std::size_t modifiedLength = static_cast<std::size_t>(env->GetStringUTFLength(str));
+	if (modifiedLength + 1 > capacity)
+		return modifiedLength + 1;
+	env->GetStringUTFRegion(str, 0, length, buffer);
+	buffer[modifiedLength] = '\0';
+	// One byte per char means ASCII without NUL, which needs no rewriting.
+	if (modifiedLength == static_cast<std::size_t>(length))
+		return modifiedLength;
+	std::size_t n = modified_utf8_to_utf8(buffer, modifiedLength, buffer);
+	buffer[n] = '\0';
+	return n;
+}
+
+// The UTF-16 contents of a jstring, held in an inline buffer of
+// InlineBytes bytes and on the heap only when longer. Reusing one object
+// with assign() also reuses its heap buffer.
+template<std::size_t InlineBytes = 256>
+class utf16_string_buffer
+{
+public:
+	static const std::size_t inline_capacity = InlineBytes / sizeof(jchar);
+
+	utf16_string_buffer() : m_data(m_inline), m_size(0), m_heapCapacity(0) {}
+
+	utf16_string_buffer(JNIEnv* env, jstring str) : m_data(m_inline), m_size(0), m_heapCapacity(0)
+	{
+		assign(env, str);
+	}
+
+	void assign(JNIEnv* env, jstring str)
+	{
+		jsize length = env->GetStringLength(str);
+		m_data = reserve(static_cast<std::size_t>(length));
+		m_size = static_cast<std::size_t>(length);
+		if (length > 0)
+			env->GetStringRegion(str, 0, length, m_data);
+	}
+
+	const jchar* data() const { return m_data; }
+	std::size_t size() const { return m_size; }
+	bool empty() const { return m_size == 0; }
+	const jchar* begin() const { return m_data; }
+	const jchar* end() const { return m_data + m_size; }
+
+#ifdef KONATA_JNI_HAS_STRING_VIEW
+	std::u16string_view view() const
+	{
+		return std::u16string_view(reinterpret_cast<const char16_t*>(m_data), m_size);
+	}
+#endif
+
+private:
+	utf16_string_buffer(utf16_string_buffer const&);
+	utf16_string_buffer& operator=(utf16_string_buffer const&);
+
+	jchar* reserve(std::size_t n)
+	{
+		if (n <= inline_capacity)
+			return m_inline;
+		if (n > m_heapCapacity)
+		{
+			m_heap.reset(new jchar[n]);
+			m_heapCapacity = n;
+		}
+		return m_heap.get();
+	}
+
+	jchar m_inline[inline_capacity];
+	std::unique_ptr<jchar[]> m_heap;
+	jchar* m_data;
+	std::size_t m_size;
+	std::size_t m_heapCapacity;
+};
+
+// The standard UTF-8 contents of a jstring (NUL terminated, though it may
+// contain NULs of its own), held like utf16_string_buffer.
+template<std::size_t InlineBytes = 256>
+class utf8_string_buffer
+{
+public:
+	utf8_string_buffer() : m_data(m_inline), m_size(0), m_heapCapacity(0)
+	{
+		m_inline[0] = '\0';
+	}
+
+	utf8_string_buffer(JNIEnv* env, jstring str) : m_data(m_inline), m_size(0), m_heapCapacity(0)
+	{
+		assign(env, str);
+	}
+
+	void assign(JNIEnv* env, jstring str)
+	{
+		std::size_t n = copy_string_utf8(env, str, m_inline, InlineBytes);
+		if (n < InlineBytes)
+		{
+			m_data = m_inline;
+		}
+		else
+		{
+			if (n > m_heapCapacity)
+			{
+				m_heap.reset(new char[n]);
+				m_heapCapacity = n;
+			}
+			m_data = m_heap.get();
+			n = copy_string_utf8(env, str, m_data, m_heapCapacity);
+		}
+		m_size = n;
+	}
+
+	const char* data() const { return m_data; }
+	const char* c_str() const { return m_data; }
+	std::size_t size() const { return m_size; }
+	bool empty() const { return m_size == 0; }
+	const char* begin() const { return m_data; }
+	const char* end() const { return m_data + m_size; }
+	std::string str() const { return std::string(m_data, m_size); }
+
+#ifdef KONATA_JNI_HAS_STRING_VIEW
+	std::string_view view() const
+	{
+		return std::string_view(m_data, m_size);
+	}
+#endif
+
+private:
+	utf8_string_buffer(utf8_string_buffer const&);
+	utf8_string_buffer& operator=(utf8_string_buffer const&);
+
+	char m_inline[InlineBytes];
+	std::unique_ptr<char[]> m_heap;
+	char* m_data;
+	std::size_t m_size;
+	std::size_t m_heapCapacity;
+};
+
+} // namespace jni
+} // namespace konata
+
+#endif // KONATA_JNI_STRING_BUFFER_HPP
@@ -0,0 +1,523 @@
+// konata/jni/transcode.hpp
+//
+// Copyright (c) Egtra 2026
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt )
+
+#ifndef KONATA_JNI_TRANSCODE_HPP
+#define KONATA_JNI_TRANSCODE_HPP
+
+#include <cstddef>
+#include <jni.h>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define KONATA_JNI_TRANSCODE_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define KONATA_JNI_TARGET(isa)
+#else
+#define KONATA_JNI_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+// Conversions between the encodings met at the JNI boundary:
+//   UTF-16           GetStringChars, GetStringCritical, GetStringRegion
+//   modified UTF-8   GetStringUTFChars, GetStringUTFRegion, NewStringUTF
+//                    (NUL as C0 80, supplementary characters as two
+//                    3-byte surrogates)
+//   standard UTF-8
+// Each function writes to out, which must hold the documented maximum,
+// and returns the number of code units written. Runs of ASCII are
+// converted 16 or 32 at a time with SSE4.1 or AVX2, whichever the CPU
+// supports; everything else goes through a scalar path. Ill-formed input
+// (unpaired surrogates, invalid UTF-8 bytes) becomes U+FFFD.
+
+namespace konata
+{
+namespace jni
+{
+
+enum class transcode_isa
+{
+	scalar,
+	sse4_1,
+	avx2,
+};
+
+namespace detail {
+
+// ASCII kernels: convert the longest prefix made of whole blocks of ASCII
+// (without NUL when no_nul is set) and return its length.
+struct transcode_kernels
+{
+	transcode_isa isa;
+	std::size_t (*copy_ascii)(const unsigned char* in, std::size_t n, unsigned char* out, bool no_nul);
+	std::size_t (*widen_ascii)(const unsigned char* in, std::size_t n, jchar* out);
+	std::size_t (*narrow_ascii)(const jchar* in, std::size_t n, unsigned char* out, bool no_nul);
+};
+
+inline std::size_t copy_ascii_scalar(const unsigned char*, std::size_t, unsigned char*, bool) { return 0; }
+inline std::size_t widen_ascii_scalar(const unsigned char*, std::size_t, jchar*) { return 0; }
+inline std::size_t narrow_ascii_scalar(const jchar*, std::size_t, unsigned char*, bool) { return 0; }
+
+#ifdef KONATA_JNI_TRANSCODE_X86
+
+KONATA_JNI_TARGET("sse4.1")
+inline std::size_t copy_ascii_sse4_1(const unsigned char* in, std::size_t n, unsigned char* out, bool no_nul)
+{
+	std::size_t i = 0;
+	const __m128i zero = _mm_setzero_si128();
+	for (; i + 16 <= n; i += 16)
+	{
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+		int bad = _mm_movemask_epi8(v);
+		if (no_nul)
+			bad |= _mm_movemask_epi8(_mm_cmpeq_epi8(v, zero));
+		if (bad != 0)
+			break;
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), v);
+	}
+	return i;
+}
+
+KONATA_JNI_TARGET("sse4.1")
+inline std::size_t widen_ascii_sse4_1(const unsigned char* in, std::size_t n, jchar* out)
+{
+	std::size_t i = 0;
+	for (; i + 16 <= n; i += 16)
+	{
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+		if (_mm_movemask_epi8(v) != 0)
+			break;
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_cvtepu8_epi16(v));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 8), _mm_cvtepu8_epi16(_mm_srli_si128(v, 8)));
+	}
+	return i;
+}
+
+KONATA_JNI_TARGET("sse4.1")
+inline std::size_t narrow_ascii_sse4_1(const jchar* in, std::size_t n, unsigned char* out, bool no_nul)
+{
+	std::size_t i = 0;
+	const __m128i high = _mm_set1_epi16(static_cast<short>(0xFF80));
+	const __m128i zero = _mm_setzero_si128();
+	for (; i + 16 <= n; i += 16)
+	{
+		__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+		__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 8));
+		if (!_mm_testz_si128(_mm_or_si128(a, b), high))
+			break;
+		__m128i packed = _mm_packus_epi16(a, b);
+		if (no_nul && _mm_movemask_epi8(_mm_cmpeq_epi8(packed, zero)) != 0)
+			break;
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), packed);
+	}
+	return i;
+}
+
+KONATA_JNI_TARGET("avx2")
+inline std::size_t copy_ascii_avx2(const unsigned char* in, std::size_t n, unsigned char* out, bool no_nul)
+{
+	std::size_t i = 0;
+	const __m256i zero = _mm256_setzero_si256();
+	for (; i + 32 <= n; i += 32)
+	{
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+		int bad = _mm256_movemask_epi8(v);
+		if (no_nul)
+			bad |= _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, zero));
+		if (bad != 0)
+			break;
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), v);
+	}
+	return i + copy_ascii_sse4_1(in + i, n - i, out + i, no_nul);
+}
+
+KONATA_JNI_TARGET("avx2")
+inline std::size_t widen_ascii_avx2(const unsigned char* in, std::size_t n, jchar* out)
+{
+	std::size_t i = 0;
+	for (; i + 32 <= n; i += 32)
+	{
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+		if (_mm256_movemask_epi8(v) != 0)
+			break;
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_cvtepu8_epi16(_mm256_castsi256_si128(v)));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i + 16), _mm256_cvtepu8_epi16(_mm256_extracti128_si256(v, 1)));
+	}
+	return i + widen_ascii_sse4_1(in + i, n - i, out + i);
+}
+
+KONATA_JNI_TARGET("avx2")
+inline std::size_t narrow_ascii_avx2(const jchar* in, std::size_t n, unsigned char* out, bool no_nul)
+{
+	std::size_t i = 0;
+	const __m256i high = _mm256_set1_epi16(static_cast<short>(0xFF80));
+	const __m256i zero = _mm256_setzero_si256();
+	for (; i + 32 <= n; i += 32)
+	{
+		__m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+		__m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i + 16));
+		if (!_mm256_testz_si256(_mm256_or_si256(a, b), high))
+			break;
+		// packus works per 128-bit lane; restore the order of the quadwords.
+		__m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8);
+		if (no_nul && _mm256_movemask_epi8(_mm256_cmpeq_epi8(packed, zero)) != 0)
+			break;
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), packed);
+	}
+	return i + narrow_ascii_sse4_1(in + i, n - i, out + i, no_nul);
+}
+
+inline transcode_isa detect_transcode_isa()
+{
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	int maxLeaf = info[0];
+	__cpuid(info, 1);
+	bool sse41 = (info[2] & (1 << 19)) != 0;
+	bool osxsave = (info[2] & (1 << 27)) != 0;
+	bool avx = (info[2] & (1 << 28)) != 0;
+	bool avx2 = false;
+	if (maxLeaf >= 7 && osxsave && avx && (_xgetbv(0) & 6) == 6)
+	{
+		__cpuidex(info, 7, 0);
+		avx2 = (info[1] & (1 << 5)) != 0;
+	}
+#else
+	__builtin_cpu_init();
+	bool sse41 = __builtin_cpu_supports("sse4.1") != 0;
+	bool avx2 = __builtin_cpu_supports("avx2") != 0;
+#endif
+	return avx2 ? transcode_isa::avx2 : sse41 ? transcode_isa::sse4_1 : transcode_isa::scalar;
+}
+
+#endif // KONATA_JNI_TRANSCODE_X86
+
+inline transcode_kernels make_transcode_kernels(transcode_isa isa)
+{
+	transcode_kernels k = { transcode_isa::scalar, &copy_ascii_scalar, &widen_ascii_scalar, &narrow_ascii_scalar };
+#ifdef KONATA_JNI_TRANSCODE_X86
+	if (isa == transcode_isa::avx2)
+	{
+		transcode_kernels avx2 = { transcode_isa::avx2, &copy_ascii_avx2, &widen_ascii_avx2, &narrow_ascii_avx2 };
+		k = avx2;
+	}
+	else if (isa == transcode_isa::sse4_1)
+	{
+		transcode_kernels sse41 = { transcode_isa::sse4_1, &copy_ascii_sse4_1, &widen_ascii_sse4_1, &narrow_ascii_sse4_1 };
+		k = sse41;
+	}
+#else
+	(void)isa;
+#endif
+	return k;
+}
+
+// Forces a kernel set (e.g. to compare the paths in tests); null restores
+// the detected one.
+inline const transcode_kernels*& transcode_kernels_override()
+{
+	static const transcode_kernels* p = 0;
+	return p;
+}
+
+inline const transcode_kernels& active_transcode_kernels()
+{
+	if (const transcode_kernels* p = transcode_kernels_override())
+		return *p;
+#ifdef KONATA_JNI_TRANSCODE_X86
+	static const transcode_kernels k = make_transcode_kernels(detect_transcode_isa());
+#else
+	static const transcode_kernels k = make_transcode_kernels(transcode_isa::scalar);
+#endif
+	return k;
+}
+
+// Below this many remaining units the kernels cannot fill a block.
+const std::size_t transcode_block = 16;
+
+inline bool is_continuation(unsigned char c) { return (c & 0xC0) == 0x80; }
+
+// Decodes one UTF-8 sequence at in[0] (n > 0 bytes available) into a code
+// point and returns its length. When modified is set, C0 80 decodes to
+// NUL; encoded surrogates are returned as they are either way, for the
+// caller to pair up or reject. Invalid sequences yield (U+FFFD, 1).
+inline std::size_t decode_utf8(const unsigned char* in, std::size_t n, unsigned long& cp, bool modified)
+{
+	unsigned char c = in[0];
+	if (c < 0x80)
+	{
+		cp = c;
+		return 1;
+	}
+	if (c >= 0xC2 && c < 0xE0)
+	{
+		if (n >= 2 && is_continuation(in[1]))
+		{
+			cp = ((c & 0x1Ful) << 6) | (in[1] & 0x3Ful);
+			return 2;
+		}
+	}
+	else if (c == 0xC0)
+	{
+		if (modified && n >= 2 && in[1] == 0x80)
+		{
+			cp = 0;
+			return 2;
+		}
+	}
+	else if (c >= 0xE0 && c < 0xF0)
+	{
+		if (n >= 3 && is_continuation(in[1]) && is_continuation(in[2]))
+		{
+			cp = ((c & 0x0Ful) << 12) | ((in[1] & 0x3Ful) << 6) | (in[2] & 0x3Ful);
+			if (cp >= 0x800)
+				return 3;
+		}
+	}
+	else if (c >= 0xF0 && c < 0xF5)
+	{
+		if (n >= 4 && is_continuation(in[1]) && is_continuation(in[2]) && is_continuation(in[3]))
+		{
+			cp = ((c & 0x07ul) << 18) | ((in[1] & 0x3Ful) << 12) | ((in[2] & 0x3Ful) << 6) | (in[3] & 0x3Ful);
+			if (cp >= 0x10000 && cp <= 0x10FFFF)
+				return 4;
+		}
+	}
+	cp = 0xFFFD;
+	return 1;
+}
+
+inline bool is_high_surrogate(unsigned long cp) { return cp >= 0xD800 && cp <= 0xDBFF; }
+inline bool is_low_surrogate(unsigned long cp) { return cp >= 0xDC00 && cp <= 0xDFFF; }
+
+// Decodes a code point at in[0], pairing encoded surrogates when the
+// input is modified UTF-8 (or CESU-8 slipped into standard UTF-8).
+inline std::size_t decode_utf8_pairing(const unsigned char* in, std::size_t n, unsigned long& cp, bool modified)
+{
+	std::size_t len = decode_utf8(in, n, cp, modified);
+	if (is_high_surrogate(cp))
+	{
+		unsigned long low;
+		if (len < n && decode_utf8(in + len, n - len, low, modified) == 3 && is_low_surrogate(low))
+		{
+			cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+			return len + 3;
+		}
+		cp = 0xFFFD;
+	}
+	else if (is_low_surrogate(cp))
+	{
+		cp = 0xFFFD;
+	}
+	return len;
+}
+
+inline unsigned char* encode_utf8(unsigned long cp, unsigned char* out)
+{
+	if (cp < 0x80)
+	{
+		*out++ = static_cast<unsigned char>(cp);
+	}
+	else if (cp < 0x800)
+	{
+		*out++ = static_cast<unsigned char>(0xC0 | (cp >> 6));
+		*out++ = static_cast<unsigned char>(0x80 | (cp & 0x3F));
+	}
+	else if (cp < 0x10000)
+	{
+		*out++ = static_cast<unsigned char>(0xE0 | (cp >> 12));
+		*out++ = static_cast<unsigned char>(0x80 | ((cp >> 6) & 0x3F));
+		*out++ = static_cast<unsigned char>(0x80 | (cp & 0x3F));
+	}
+	else
+	{
+		*out++ = static_cast<unsigned char>(0xF0 | (cp >> 18));
+		*out++ = static_cast<unsigned char>(0x80 | ((cp >> 12) & 0x3F));
+		*out++ = static_cast<unsigned char>(0x80 | ((cp >> 6) & 0x3F));
+		*out++ = static_cast<unsigned char>(0x80 | (cp & 0x3F));
+	}
+	return out;
+}
+
+// Modified UTF-8 for one UTF-16 code unit (surrogates stay separate).
+inline unsigned char* encode_modified_utf8_unit(unsigned long unit, unsigned char* out)
+{
+	if (unit == 0)
+	{
+		*out++ = 0xC0;
+		*out++ = 0x80;
+		return out;
+	}
+	return encode_utf8(unit, out);
+}
+
+inline jchar* encode_utf16(unsigned long cp, jchar* out)
+{
+	if (cp < 0x10000)
+	{
+		*out++ = static_cast<jchar>(cp);
+	}
+	else
+	{
+		cp -= 0x10000;
+		*out++ = static_cast<jchar>(0xD800 + (cp >> 10));
+		*out++ = static_cast<jchar>(0xDC00 + (cp & 0x3FF));
+	}
+	return out;
+}
+
+template<bool Modified>
+std::size_t utf8_to_utf8(const char* input, std::size_t n, char* output)
+{
+	const unsigned char* in = reinterpret_cast<const unsigned char*>(input);
+	unsigned char* out = reinterpret_cast<unsigned char*>(output);
+	const transcode_kernels& k = active_transcode_kernels();
+	std::size_t i = 0;
+	while (i < n)
+	{
+		if (in[i] < 0x80 && n - i >= transcode_block)
+		{
+			std::size_t m = k.copy_ascii(in + i, n - i, out, Modified);
+			i += m;
+			out += m;
+			if (i == n)
+				break;
+		}
+		unsigned long cp;
+		i += decode_utf8_pairing(in + i, n - i, cp, !Modified);
+		if (Modified)
+		{
+			if (cp >= 0x10000)
+			{
+				cp -= 0x10000;
+				out = encode_utf8(0xD800 + (cp >> 10), out);
+				out = encode_utf8(0xDC00 + (cp & 0x3FF), out);
+			}
+			else
+			{
+				out = encode_modified_utf8_unit(cp, out);
+			}
+		}
+		else
+		{
+			out = encode_utf8(cp, out);
+		}
+	}
+	return static_cast<std::size_t>(out - reinterpret_cast<unsigned char*>(output));
+}
+
+template<bool Modified>
+std::size_t utf8_to_utf16(const char* input, std::size_t n, jchar* output)
+{
+	const unsigned char* in = reinterpret_cast<const unsigned char*>(input);
+	jchar* out = output;
+	const transcode_kernels& k = active_transcode_kernels();
+	std::size_t i = 0;
+	while (i < n)
+	{
+		if (in[i] < 0x80 && n - i >= transcode_block)
+		{
+			std::size_t m = k.widen_ascii(in + i, n - i, out);
+			i += m;
+			out += m;
+			if (i == n)
+				break;
+		}
+		unsigned long cp;
+		// Modified UTF-8 maps UTF-16 units one to one, unpaired surrogates
+		// included, so those are kept rather than replaced.
+		i += Modified ? decode_utf8(in + i, n - i, cp, true) : decode_utf8_pairing(in + i, n - i, cp, false);
+		out = encode_utf16(cp, out);
+	}
+	return static_cast<std::size_t>(out - output);
+}
+
+template<bool Modified>
+std::size_t utf16_to_utf8(const jchar* in, std::size_t n, char* output)
+{
+	unsigned char* out = reinterpret_cast<unsigned char*>(output);
+	const transcode_kernels& k = active_transcode_kernels();
+	std::size_t i = 0;
+	while (i < n)
+	{
+		if (in[i] < 0x80 && n - i >= transcode_block)
+		{
+			std::size_t m = k.narrow_ascii(in + i, n - i, out, Modified);
+			i += m;
+			out += m;
+			if (i == n)
+				break;
+		}
+		unsigned long unit = in[i++];
+		if (Modified)
+		{
+			out = encode_modified_utf8_unit(unit, out);
+		}
+		else if (is_high_surrogate(unit) && i < n && is_low_surrogate(in[i]))
+		{
+			out = encode_utf8(0x10000 + ((unit - 0xD800) << 10) + (in[i++] - 0xDC00ul), out);
+		}
+		else
+		{
+			out = encode_utf8(is_high_surrogate(unit) || is_low_surrogate(unit) ? 0xFFFD : unit, out);
+		}
+	}
+	return static_cast<std::size_t>(out - reinterpret_cast<unsigned char*>(output));
+}
+
+} // namespace detail
+
+// The instruction set the conversions use on this CPU.
+inline transcode_isa active_transcode_isa()
+{
+	return detail::active_transcode_kernels().isa;
+}
+
+// Modified UTF-8 -> standard UTF-8; out: n bytes for well-formed input
+// (as produced by the JVM), which may also be converted in place.
+// Invalid bytes expand to U+FFFD, so arbitrary input needs 3 * n.
+inline std::size_t modified_utf8_to_utf8(const char* in, std::size_t n, char* out)
+{
+	return detail::utf8_to_utf8<false>(in, n, out);
+}
+
+// Standard UTF-8 -> modified UTF-8 (for NewStringUTF); out: 3 * n bytes.
+inline std::size_t utf8_to_modified_utf8(const char* in, std::size_t n, char* out)
+{
+	return detail::utf8_to_utf8<true>(in, n, out);
+}
+
+// Standard UTF-8 -> UTF-16 (for NewString); out: n units.
+inline std::size_t utf8_to_utf16(const char* in, std::size_t n, jchar* out)
+{
+	return detail::utf8_to_utf16<false>(in, n, out);
+}
+
+// Modified UTF-8 -> UTF-16; out: n units.
+inline std::size_t modified_utf8_to_utf16(const char* in, std::size_t n, jchar* out)
+{
+	return detail::utf8_to_utf16<true>(in, n, out);
+}
+
+// UTF-16 -> standard UTF-8; out: 3 * n bytes.
+inline std::size_t utf16_to_utf8(const jchar* in, std::size_t n, char* out)
+{
+	return detail::utf16_to_utf8<false>(in, n, out);
+}
+
+// UTF-16 -> modified UTF-8; out: 3 * n bytes.
+inline std::size_t utf16_to_modified_utf8(const jchar* in, std::size_t n, char* out)
+{
+	return detail::utf16_to_utf8<true>(in, n, out);
+}
+
+} // namespace jni
+} // namespace konata
+
+#endif // KONATA_JNI_TRANSCODE_HPP
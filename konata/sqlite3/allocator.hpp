@@ -0,0 +1,492 @@
+/*
+sqlite3/allocator.hpp: Copyright (c) Egtra 2026
+
+Distributed under the Boost Software License, Version 1.0.
+(See accompanying file LICENSE.txt or copy at
+http://www.boost.org/LICENSE_1_0.txt )
+*/
+
+#ifndef KONATA_SQLITE3_ALLOCATOR_HPP
+#define KONATA_SQLITE3_ALLOCATOR_HPP
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <system_error>
+#include <vector>
+
+#include <konata/sqlite3/connection.hpp>
+
+namespace konata
+{
+namespace sqlite3
+{
+
+struct pool_allocator_options
+{
+	// If set, every pooled block is carved from this buffer, which must be
+	// 16-byte aligned and outlive the allocator.
+	void* arena = nullptr;
+	std::size_t arena_size = 0;
+	// Serve allocations larger than the largest size class, and pooled ones
+	// once the arena is exhausted, from std::malloc. Without it such
+	// requests fail and SQLite reports SQLITE_NOMEM.
+	bool system_fallback = true;
+	// Upper bound of the bytes each thread keeps cached per size class.
+	std::size_t thread_cache_bytes = 64 * 1024;
+};
+
+struct size_class_statistics
+{
+	std::size_t block_size;
+	std::uint64_t live_blocks;
+	std::uint64_t allocations;
+	std::uint64_t reserved_blocks;
+};
+
+struct pool_allocator_statistics
+{
+	std::uint64_t live_bytes;
+	std::uint64_t peak_bytes;
+	std::uint64_t reserved_bytes;
+	std::uint64_t large_allocations;
+	std::uint64_t failed_allocations;
+	std::vector<size_class_statistics> classes;
+};
+
+// Size-class pool allocator for SQLite, installed with SQLITE_CONFIG_MALLOC.
+// Blocks from 32 bytes to 1 MiB come in two sizes per power of two; each
+// thread caches freed blocks per class and exchanges them with the shared
+// pools in batches. Pool memory is only returned to the system (or arena)
+// when the allocator is destroyed.
+// SQLite's allocator is process-wide: install() must be called before
+// sqlite3_initialize() or after sqlite3_shutdown(), and the allocator must
+// outlive sqlite3_shutdown() and every thread that used SQLite.
+class pool_allocator
+{
+public:
+	static const std::size_t class_count = 31;
+	static const std::size_t max_block_size = 1024 * 1024;
+
+	explicit pool_allocator(const pool_allocator_options& options = pool_allocator_options())
+		: m_options(options)
+		, m_arenaNext(static_cast<unsigned char*>(options.arena))
+		, m_arenaEnd(static_cast<unsigned char*>(options.arena) + options.arena_size)
+		, m_live(0), m_peak(0), m_reserved(0), m_large(0), m_failed(0)
+		, m_installed(false), m_previous()
+	{
+		for (std::size_t i = 0; i < class_count; ++i)
+		{
+			auto size = block_size(i);
+			m_classes[i].limit = std::max<std::size_t>(1, std::min<std::size_t>(256, m_options.thread_cache_bytes / size));
+		}
+	}
+
+	pool_allocator(const pool_allocator&) = delete;
+	pool_allocator& operator=(const pool_allocator&) = delete;
+
+	~pool_allocator()
+	{
+		if (m_installed)
+			uninstall();
+		if (current() == this)
+			current() = nullptr;
+		thread_cache& c = local_cache();
+		if (c.owner == this)
+			c = thread_cache();
+		for (void* p : m_slabs)
+			std::free(p);
+	}
+
+	std::error_code install() noexcept
+	{
+		int rc = sqlite3_config(SQLITE_CONFIG_GETMALLOC, &m_previous);
+		if (rc == SQLITE_OK)
+		{
+			static const sqlite3_mem_methods methods =
+			{
+				&x_malloc, &x_free, &x_realloc, &x_size, &x_roundup, &x_init, &x_shutdown, nullptr,
+			};
+			current() = this;
+			rc = sqlite3_config(SQLITE_CONFIG_MALLOC, &methods);
+			if (rc == SQLITE_OK)
+				m_installed = true;
+			else
+				current() = nullptr;
+		}
+		return make_error_code_from_result(rc);
+	}
+
+	// Restores the allocator that was active before install().
+	std::error_code uninstall() noexcept
+	{
+		int rc = sqlite3_config(SQLITE_CONFIG_MALLOC, &m_previous);
+		if (rc == SQLITE_OK)
+			m_installed = false;
+		return make_error_code_from_result(rc);
+	}
+
+	void* allocate(std::size_t n) noexcept
+	{
+		std::size_t c = class_of(n + header_size);
+		header* h;
+		if (c == class_count)
+		{
+			h = m_options.system_fallback ? static_cast<header*>(std::malloc(n + header_size)) : nullptr;
+			if (h == nullptr)
+				return failed();
+			h->size = static_cast<std::uint32_t>(n);
+			h->size_class = static_cast<std::uint32_t>(class_count);
+			m_large.fetch_add(1, std::memory_order_relaxed);
+			m_reserved.fetch_add(n + header_size, std::memory_order_relaxed);
+		}
+		else
+		{
+			h = static_cast<header*>(pop(c));
+			if (h == nullptr)
+				return failed();
+			h->size = static_cast<std::uint32_t>(block_size(c) - header_size);
+			h->size_class = static_cast<std::uint32_t>(c);
+			m_classes[c].live.fetch_add(1, std::memory_order_relaxed);
+			m_classes[c].allocations.fetch_add(1, std::memory_order_relaxed);
+		}
+		add_live(h->size);
+		return h + 1;
+	}
+
+	void deallocate(void* p) noexcept
+	{
+		if (p == nullptr)
+			return;
+		header* h = static_cast<header*>(p) - 1;
+		m_live.fetch_sub(h->size, std::memory_order_relaxed);
+		if (h->size_class == class_count)
+		{
+			m_reserved.fetch_sub(h->size + header_size, std::memory_order_relaxed);
+			std::free(h);
+		}
+		else
+		{
+			m_classes[h->size_class].live.fetch_sub(1, std::memory_order_relaxed);
+			push(h->size_class, h);
+		}
+	}
+
+	void* reallocate(void* p, std::size_t n) noexcept
+	{
+		if (p == nullptr)
+			return allocate(n);
+		std::size_t old = usable_size(p);
+		header* h = static_cast<header*>(p) - 1;
+		if (n <= old && (h->size_class == class_count || class_of(n + header_size) == h->size_class))
+			return p;
+		void* q = allocate(n);
+		if (q == nullptr)
+			return nullptr;
+		std::memcpy(q, p, std::min(old, n));
+		deallocate(p);
+		return q;
+	}
+
+	static std::size_t usable_size(const void* p) noexcept
+	{
+		return p != nullptr ? (static_cast<const header*>(p) - 1)->size : 0;
+	}
+
+	static std::size_t round_up(std::size_t n) noexcept
+	{
+		std::size_t c = class_of(n + header_size);
+		return c == class_count ? (n + 7) & ~std::size_t(7) : block_size(c) - header_size;
+	}
+
+	pool_allocator_statistics statistics() const
+	{
+		pool_allocator_statistics s;
+		s.live_bytes = m_live.load(std::memory_order_relaxed);
+		s.peak_bytes = m_peak.load(std::memory_order_relaxed);
+		s.reserved_bytes = m_reserved.load(std::memory_order_relaxed);
+		s.large_allocations = m_large.load(std::memory_order_relaxed);
+		s.failed_allocations = m_failed.load(std::memory_order_relaxed);
+		s.classes.reserve(class_count);
+		for (std::size_t i = 0; i < class_count; ++i)
+		{
+			size_class_statistics c;
+			c.block_size = block_size(i);
+			c.live_blocks = m_classes[i].live.load(std::memory_order_relaxed);
+			c.allocations = m_classes[i].allocations.load(std::memory_order_relaxed);
+			c.reserved_blocks = m_classes[i].reserved.load(std::memory_order_relaxed);
+			s.classes.push_back(c);
+		}
+		return s;
+	}
+
+	// 32, 48, 64, 96, 128, ..., 768 KiB, 1 MiB
+	static std::size_t block_size(std::size_t c) noexcept
+	{
+		std::size_t base = std::size_t(32) << (c / 2);
+		return c % 2 == 0 ? base : base + base / 2;
+	}
+
+private:
+	struct header
+	{
+		std::uint32_t size;
+		std::uint32_t size_class;
+	};
+	static const std::size_t header_size = sizeof(header);
+
+	struct free_block
+	{
+		free_block* next;
+	};
+
+	struct size_class
+	{
+		size_class() noexcept : head(), count(0), limit(1), live(0), allocations(0), reserved(0) {}
+
+		std::mutex mutex;
+		free_block* head;
+		std::size_t count;
+		std::size_t limit; // per-thread cache capacity
+		std::atomic<std::uint64_t> live;
+		std::atomic<std::uint64_t> allocations;
+		std::atomic<std::uint64_t> reserved;
+	};
+
+	struct thread_cache
+	{
+		struct list
+		{
+			free_block* head;
+			std::size_t count;
+		};
+
+		thread_cache() noexcept : owner(), lists() {}
+
+		~thread_cache()
+		{
+			if (owner != nullptr)
+				owner->flush(*this);
+		}
+
+		pool_allocator* owner;
+		list lists[class_count];
+	};
+
+	static pool_allocator*& current() noexcept
+	{
+		static pool_allocator* instance;
+		return instance;
+	}
+
+	static thread_cache& local_cache() noexcept
+	{
+		thread_local thread_cache cache;
+		return cache;
+	}
+
+	static std::size_t class_of(std::size_t n) noexcept
+	{
+		if (n > max_block_size)
+			return class_count;
+		std::size_t lo = 0, hi = class_count - 1;
+		while (lo < hi)
+		{
+			std::size_t mid = (lo + hi) / 2;
+			if (block_size(mid) < n)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		return lo;
+	}
+
+	void* failed() noexcept
+	{
+		m_failed.fetch_add(1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	void add_live(std::uint64_t n) noexcept
+	{
+		auto live = m_live.fetch_add(n, std::memory_order_relaxed) + n;
+		auto peak = m_peak.load(std::memory_order_relaxed);
+		while (peak < live && !m_peak.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+		{
+		}
+	}
+
+	thread_cache* cache() noexcept
+	{
+		thread_cache& c = local_cache();
+		if (c.owner == nullptr)
+			c.owner = this;
+		return c.owner == this ? &c : nullptr;
+	}
+
+	void* pop(std::size_t c) noexcept
+	{
+		thread_cache* tc = cache();
+		if (tc == nullptr)
+			return pop_shared(c, nullptr);
+		auto& l = tc->lists[c];
+		if (l.head == nullptr)
+			return pop_shared(c, &l);
+		free_block* b = l.head;
+		l.head = b->next;
+		--l.count;
+		return b;
+	}
+
+	void push(std::size_t c, void* p) noexcept
+	{
+		auto b = static_cast<free_block*>(p);
+		thread_cache* tc = cache();
+		if (tc == nullptr)
+		{
+			std::lock_guard<std::mutex> lock(m_classes[c].mutex);
+			b->next = m_classes[c].head;
+			m_classes[c].head = b;
+			++m_classes[c].count;
+			return;
+		}
+		auto& l = tc->lists[c];
+		b->next = l.head;
+		l.head = b;
+		if (++l.count > m_classes[c].limit)
+			release_to_shared(c, l, l.count / 2);
+	}
+
+	// Takes one block for the caller and, if l is given, a batch for the
+	// thread cache; the shared pool is refilled with a new slab when empty.
+	void* pop_shared(std::size_t c, thread_cache::list* l) noexcept
+	{
+		size_class& sc = m_classes[c];
+		std::size_t batch = l != nullptr ? (sc.limit + 1) / 2 : 0;
+		std::lock_guard<std::mutex> lock(sc.mutex);
+		if (sc.head == nullptr && !refill(c))
+			return nullptr;
+		free_block* ret = sc.head;
+		sc.head = ret->next;
+		--sc.count;
+		for (std::size_t i = 0; i < batch && sc.head != nullptr; ++i)
+		{
+			free_block* b = sc.head;
+			sc.head = b->next;
+			--sc.count;
+			b->next = l->head;
+			l->head = b;
+			++l->count;
+		}
+		return ret;
+	}
+
+	void release_to_shared(std::size_t c, thread_cache::list& l, std::size_t n) noexcept
+	{
+		if (n == 0)
+			return;
+		free_block* first = l.head;
+		free_block* last = first;
+		for (std::size_t i = 1; i < n; ++i)
+			last = last->next;
+		l.head = last->next;
+		l.count -= n;
+		size_class& sc = m_classes[c];
+		std::lock_guard<std::mutex> lock(sc.mutex);
+		last->next = sc.head;
+		sc.head = first;
+		sc.count += n;
+	}
+
+	void flush(thread_cache& tc) noexcept
+	{
+		for (std::size_t c = 0; c < class_count; ++c)
+			release_to_shared(c, tc.lists[c], tc.lists[c].count);
+		tc.owner = nullptr;
+	}
+
+	// Called with m_classes[c].mutex held.
+	bool refill(std::size_t c) noexcept
+	{
+		std::size_t size = block_size(c);
+		std::size_t count = std::max<std::size_t>(1, 64 * 1024 / size);
+		unsigned char* slab = allocate_slab(size * count);
+		if (slab == nullptr)
+			return false;
+		size_class& sc = m_classes[c];
+		for (std::size_t i = count; i-- > 0;)
+		{
+			auto b = reinterpret_cast<free_block*>(slab + i * size);
+			b->next = sc.head;
+			sc.head = b;
+		}
+		sc.count += count;
+		sc.reserved.fetch_add(count, std::memory_order_relaxed);
+		return true;
+	}
+
+	unsigned char* allocate_slab(std::size_t size) noexcept
+	{
+		std::lock_guard<std::mutex> lock(m_slabMutex);
+		if (m_arenaNext != nullptr && static_cast<std::size_t>(m_arenaEnd - m_arenaNext) >= size)
+		{
+			unsigned char* p = m_arenaNext;
+			m_arenaNext += size;
+			m_reserved.fetch_add(size, std::memory_order_relaxed);
+			return p;
+		}
+		if (m_options.arena != nullptr && !m_options.system_fallback)
+			return nullptr;
+		try
+		{
+			m_slabs.reserve(m_slabs.size() + 1);
+		}
+		catch (...)
+		{
+			return nullptr;
+		}
+		auto p = static_cast<unsigned char*>(std::malloc(size));
+		if (p != nullptr)
+		{
+			m_slabs.push_back(p);
+			m_reserved.fetch_add(size, std::memory_order_relaxed);
+		}
+		return p;
+	}
+
+	static void* x_malloc(int n) { return n > 0 ? current()->allocate(static_cast<std::size_t>(n)) : nullptr; }
+	static void x_free(void* p) { current()->deallocate(p); }
+	static void* x_realloc(void* p, int n) { return current()->reallocate(p, static_cast<std::size_t>(n)); }
+	static int x_size(void* p) { return static_cast<int>(usable_size(p)); }
+	static int x_roundup(int n) { return static_cast<int>(round_up(static_cast<std::size_t>(n))); }
+	static int x_init(void*) { return SQLITE_OK; }
+	static void x_shutdown(void*) {}
+
+	pool_allocator_options m_options;
+	size_class m_classes[class_count];
+
+	std::mutex m_slabMutex;
+	unsigned char* m_arenaNext;
+	unsigned char* m_arenaEnd;
+	std::vector<void*> m_slabs;
+
+	std::atomic<std::uint64_t> m_live;
+	std::atomic<std::uint64_t> m_peak;
+	std::atomic<std::uint64_t> m_reserved;
+	std::atomic<std::uint64_t> m_large;
+	std::atomic<std::uint64_t> m_failed;
+
+	bool m_installed;
+	sqlite3_mem_methods m_previous;
+};
+
+} // namespace sqlite3
+} // namespace konata
+
+#endif // KONATA_SQLITE3_ALLOCATOR_HPP
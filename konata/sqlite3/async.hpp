@@ -0,0 +1,308 @@
+/*
+sqlite3/async.hpp: Copyright (c) Egtra 2026
+
+Distributed under the Boost Software License, Version 1.0.
+(See accompanying file LICENSE.txt or copy at
+http://www.boost.org/LICENSE_1_0.txt )
+*/
+
+#ifndef KONATA_SQLITE3_ASYNC_HPP
+#define KONATA_SQLITE3_ASYNC_HPP
+
+#pragma once
+
+// Requires C++20.
+
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <konata/sqlite3/connection.hpp>
+#include <konata/sqlite3/query.hpp>
+#include <konata/sqlite3/result.hpp>
+
+namespace konata
+{
+namespace sqlite3
+{
+
+// Outcome of an asynchronous request. The error is in sqlite3_error_category;
+// SQLITE_INTERRUPT (operation_canceled) means the request was cancelled.
+template<typename T>
+using async_result = result<T>;
+
+// Runs work for one connection on a dedicated thread. Requests are executed
+// in submission order and awaited with co_await; the awaiting coroutine is
+// resumed on the worker thread, or handed to the executor given to
+// set_resume_executor().
+class async_connection
+{
+	class job_base
+	{
+	public:
+		enum state_type { queued, running, done, cancelled };
+
+		job_base() : state(queued) {}
+		virtual ~job_base() = default;
+		virtual void run(connection& c) = 0;
+		virtual void fail(std::error_code ec) noexcept = 0;
+
+		std::coroutine_handle<> continuation;
+		state_type state; // guarded by async_connection::m_stateMutex
+	};
+
+	template<typename T>
+	class job : public job_base
+	{
+	public:
+		template<typename F>
+		explicit job(F&& f) : m_function(std::forward<F>(f)) {}
+
+		void run(connection& c) override
+		{
+			try
+			{
+				if constexpr (std::is_void<T>::value)
+				{
+					m_function(c);
+					outcome.emplace();
+				}
+				else
+				{
+					outcome.emplace(m_function(c));
+				}
+			}
+			catch (const std::system_error& e)
+			{
+				outcome.emplace(e.code());
+			}
+			catch (const std::bad_alloc&)
+			{
+				outcome.emplace(make_error_code_from_result(SQLITE_NOMEM));
+			}
+			catch (...)
+			{
+				exception = std::current_exception();
+			}
+		}
+
+		void fail(std::error_code ec) noexcept override
+		{
+			outcome.emplace(ec);
+		}
+
+		std::optional<async_result<T>> outcome;
+		std::exception_ptr exception;
+
+	private:
+		std::function<T(connection&)> m_function;
+	};
+
+public:
+	template<typename T>
+	class awaitable
+	{
+	public:
+		bool await_ready() const noexcept { return false; }
+
+		void await_suspend(std::coroutine_handle<> h)
+		{
+			m_job->continuation = h;
+			if (m_stop.stop_possible())
+				m_stopCallback.emplace(m_stop, canceller{ m_owner, m_job.get() });
+			m_owner->enqueue(m_job);
+		}
+
+		// Exceptions other than std::system_error and std::bad_alloc thrown by
+		// the request are rethrown here.
+		async_result<T> await_resume()
+		{
+			m_stopCallback.reset();
+			if (m_job->exception)
+				std::rethrow_exception(m_job->exception);
+			return std::move(*m_job->outcome);
+		}
+
+	private:
+		friend class async_connection;
+
+		struct canceller
+		{
+			void operator()() const noexcept { owner->cancel(*target); }
+			async_connection* owner;
+			job_base* target;
+		};
+
+		awaitable(async_connection* owner, std::shared_ptr<job<T>> j, std::stop_token st)
+			: m_owner(owner), m_job(std::move(j)), m_stop(std::move(st)) {}
+
+		async_connection* m_owner;
+		std::shared_ptr<job<T>> m_job;
+		std::stop_token m_stop;
+		std::optional<std::stop_callback<canceller>> m_stopCallback;
+	};
+
+	explicit async_connection(connection&& c)
+		: m_connection(std::move(c)), m_stopping(false)
+	{
+		m_worker = std::thread([this] { worker_loop(); });
+	}
+
+	explicit async_connection(const char* filename, int flags = SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE)
+		: async_connection(connection(filename, flags))
+	{
+	}
+
+	async_connection(const async_connection&) = delete;
+	async_connection& operator=(const async_connection&) = delete;
+
+	// Requests still queued are run before the worker exits.
+	~async_connection()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_queueMutex);
+			m_stopping = true;
+		}
+		m_queueCondition.notify_one();
+		m_worker.join();
+	}
+
+	// Must be set before the first request is submitted.
+	void set_resume_executor(std::function<void(std::coroutine_handle<>)> executor)
+	{
+		m_resumeExecutor = std::move(executor);
+	}
+
+	// co_await run(f) executes f(connection&) on the worker thread.
+	// Requesting stop on st cancels the request: a queued request is not
+	// run, and a running one is interrupted with sqlite3_interrupt.
+	template<typename F>
+	auto run(F&& f, std::stop_token st = std::stop_token())
+	{
+		typedef decltype(f(std::declval<connection&>())) result_type;
+		return awaitable<result_type>(this, std::make_shared<job<result_type>>(std::forward<F>(f)), std::move(st));
+	}
+
+	auto exec(std::string sql, std::stop_token st = std::stop_token())
+	{
+		return run([sql = std::move(sql)](connection& c) { c.exec(sql); }, std::move(st));
+	}
+
+	// Collects every row of a typed_query. Row must own its data; views
+	// such as std::string_view do not outlive the step that produced them.
+	template<typename Row, typename... Args>
+	auto query_all(std::string sql, std::stop_token st, Args... args)
+	{
+		return run([sql = std::move(sql), args...](connection& c)
+		{
+			std::vector<Row> rows;
+			auto q = query<Row>(c.get(), sql);
+			q.bind(args...);
+			for (auto&& row : q)
+				rows.push_back(std::move(row));
+			return rows;
+		}, std::move(st));
+	}
+
+	// Interrupts the request currently running, if any.
+	void interrupt() noexcept
+	{
+		std::lock_guard<std::mutex> lock(m_stateMutex);
+		if (m_running)
+			sqlite3_interrupt(m_connection.get());
+	}
+
+private:
+	void enqueue(std::shared_ptr<job_base> j)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_queueMutex);
+			m_queue.push_back(std::move(j));
+		}
+		m_queueCondition.notify_one();
+	}
+
+	void cancel(job_base& j) noexcept
+	{
+		std::lock_guard<std::mutex> lock(m_stateMutex);
+		if (j.state == job_base::queued)
+			j.state = job_base::cancelled;
+		else if (j.state == job_base::running)
+			sqlite3_interrupt(m_connection.get());
+	}
+
+	void worker_loop()
+	{
+		std::unique_lock<std::mutex> lock(m_queueMutex);
+		for (;;)
+		{
+			m_queueCondition.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+			if (m_queue.empty())
+				return;
+			auto j = std::move(m_queue.front());
+			m_queue.pop_front();
+			lock.unlock();
+			execute(*j);
+			resume(j->continuation);
+			j.reset();
+			lock.lock();
+		}
+	}
+
+	void execute(job_base& j)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_stateMutex);
+			if (j.state == job_base::cancelled)
+			{
+				j.fail(make_error_code_from_result(SQLITE_INTERRUPT));
+				return;
+			}
+			j.state = job_base::running;
+			m_running = &j;
+		}
+		j.run(m_connection);
+		std::lock_guard<std::mutex> lock(m_stateMutex);
+		j.state = job_base::done;
+		m_running = nullptr;
+	}
+
+	void resume(std::coroutine_handle<> h)
+	{
+		if (m_resumeExecutor)
+			m_resumeExecutor(h);
+		else
+			h.resume();
+	}
+
+	connection m_connection;
+	std::function<void(std::coroutine_handle<>)> m_resumeExecutor;
+
+	std::mutex m_stateMutex;
+	job_base* m_running = nullptr;
+
+	std::deque<std::shared_ptr<job_base>> m_queue;
+	bool m_stopping;
+	std::mutex m_queueMutex;
+	std::condition_variable m_queueCondition;
+	std::thread m_worker;
+};
+
+} // namespace sqlite3
+} // namespace konata
+
+#endif // KONATA_SQLITE3_ASYNC_HPP
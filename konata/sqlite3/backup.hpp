@@ -0,0 +1,315 @@
+/*
+sqlite3/backup.hpp: Copyright (c) Egtra 2026
+
+Distributed under the Boost Software License, Version 1.0.
+(See accompanying file LICENSE.txt or copy at
+http://www.boost.org/LICENSE_1_0.txt )
+*/
+
+#ifndef KONATA_SQLITE3_BACKUP_HPP
+#define KONATA_SQLITE3_BACKUP_HPP
+
+#pragma once
+
+// wal_snapshot and snapshot_transaction require SQLITE_ENABLE_SNAPSHOT:
+// define it when your SQLite library is built with it.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+#include <konata/sqlite3/connection.hpp>
+
+namespace konata
+{
+namespace sqlite3
+{
+
+struct backup_progress
+{
+	int remaining;            // pages left in the current pass
+	int page_count;           // pages in the source
+	std::uint64_t pages_copied; // over all passes
+	unsigned restarts;        // passes started over because the source changed
+	std::chrono::steady_clock::duration elapsed;
+	int page_size;
+
+	double pages_per_second() const noexcept
+	{
+		double seconds = std::chrono::duration<double>(elapsed).count();
+		return seconds > 0 ? static_cast<double>(pages_copied) / seconds : 0.0;
+	}
+
+	double bytes_per_second() const noexcept
+	{
+		return pages_per_second() * page_size;
+	}
+};
+
+struct backup_options
+{
+	// Pages copied per sqlite3_backup_step; the source is only locked for
+	// the duration of one step.
+	int pages_per_step = 256;
+	// Pause between steps, giving writers a chance to run; 0 just yields.
+	std::chrono::milliseconds step_delay = std::chrono::milliseconds(0);
+	// Passes restarted because another connection wrote to the source
+	// before the copy finishes; beyond this the backup fails with
+	// SQLITE_BUSY. 0 means no limit.
+	unsigned max_restarts = 16;
+	// How long steps may keep finding the source or destination busy
+	// before the backup fails with SQLITE_BUSY.
+	std::chrono::milliseconds busy_timeout = std::chrono::milliseconds(5000);
+	// Called after each step; returning false cancels with SQLITE_INTERRUPT.
+	std::function<bool(const backup_progress&)> progress;
+};
+
+// Incremental copy of a live database with sqlite3_backup_*. SQLite
+// restarts the copy by itself when another connection modifies the
+// source, and carries changes made through the source connection over to
+// the destination; the result is always a consistent image.
+class online_backup
+{
+public:
+	online_backup(::sqlite3* destination, ::sqlite3* source, const char* destinationName = "main", const char* sourceName = "main")
+		: m_destination(destination), m_backup(nullptr),
+		m_lastRemaining(-1), m_pagesCopied(0), m_restarts(0), m_pageSize(0), m_busy(false), m_start(std::chrono::steady_clock::now())
+	{
+		// Before sqlite3_backup_init, so that nothing throws while the
+		// handle (and the lock on the destination) is held.
+		{
+			statement pageSize(source, "PRAGMA \"" + std::string(sourceName) + "\".page_size");
+			if (pageSize.step())
+				m_pageSize = pageSize.column_int(0);
+		}
+		m_backup = sqlite3_backup_init(destination, destinationName, source, sourceName);
+		if (m_backup == nullptr)
+			throw_if_error(sqlite3_errcode(destination), destination);
+	}
+
+	online_backup(const online_backup&) = delete;
+	online_backup& operator=(const online_backup&) = delete;
+
+	~online_backup()
+	{
+		if (m_backup != nullptr)
+			sqlite3_backup_finish(m_backup);
+	}
+
+	// Copies up to pages pages (negative: all). Returns true once the copy
+	// is complete; a busy or locked database is not an error (see busy()),
+	// the step is simply retried later.
+	bool step(int pages)
+	{
+		int before = sqlite3_backup_remaining(m_backup);
+		int rc = sqlite3_backup_step(m_backup, pages);
+		if (rc != SQLITE_OK && rc != SQLITE_DONE && rc != SQLITE_BUSY && rc != SQLITE_LOCKED)
+			fail(rc);
+		int remaining = sqlite3_backup_remaining(m_backup);
+		int pageCount = sqlite3_backup_pagecount(m_backup);
+		if (m_lastRemaining < 0)
+		{
+			m_pagesCopied += static_cast<std::uint64_t>(pageCount - remaining);
+		}
+		else if (rc != SQLITE_BUSY && rc != SQLITE_LOCKED)
+		{
+			int copied = pages < 0 ? before : std::min(pages, before);
+			if (remaining > before - copied)
+			{
+				// The pass started over: this step copied from a fresh total.
+				++m_restarts;
+				m_pagesCopied += static_cast<std::uint64_t>(pageCount - remaining);
+			}
+			else
+			{
+				m_pagesCopied += static_cast<std::uint64_t>(before - remaining);
+			}
+		}
+		m_lastRemaining = remaining;
+		m_busy = rc == SQLITE_BUSY || rc == SQLITE_LOCKED;
+		return rc == SQLITE_DONE;
+	}
+
+	// Steps until the copy completes, then finishes the backup.
+	void run(const backup_options& options = backup_options())
+	{
+		std::chrono::steady_clock::time_point busySince;
+		for (;;)
+		{
+			bool wasBusy = m_busy;
+			bool done = step(options.pages_per_step);
+			if (options.max_restarts != 0 && m_restarts > options.max_restarts)
+				fail(SQLITE_BUSY);
+			if (m_busy)
+			{
+				auto now = std::chrono::steady_clock::now();
+				if (!wasBusy)
+					busySince = now;
+				else if (now - busySince >= options.busy_timeout)
+					fail(SQLITE_BUSY);
+			}
+			if (options.progress && !options.progress(progress()))
+				fail(SQLITE_INTERRUPT);
+			if (done)
+				break;
+			if (options.step_delay.count() > 0)
+				std::this_thread::sleep_for(options.step_delay);
+			else
+				std::this_thread::yield();
+		}
+		finish();
+	}
+
+	void finish()
+	{
+		int rc = sqlite3_backup_finish(m_backup);
+		m_backup = nullptr;
+		throw_if_error(rc, m_destination);
+	}
+
+	// Whether the last step could not proceed because of a lock.
+	bool busy() const noexcept { return m_busy; }
+
+	backup_progress progress() const noexcept
+	{
+		backup_progress p;
+		p.remaining = m_backup != nullptr ? sqlite3_backup_remaining(m_backup) : 0;
+		p.page_count = m_backup != nullptr ? sqlite3_backup_pagecount(m_backup) : 0;
+		p.pages_copied = m_pagesCopied;
+		p.restarts = m_restarts;
+		p.elapsed = std::chrono::steady_clock::now() - m_start;
+		p.page_size = m_pageSize;
+		return p;
+	}
+
+private:
+	[[noreturn]] void fail(int rc)
+	{
+		sqlite3_backup_finish(m_backup);
+		m_backup = nullptr;
+		throw std::system_error(rc, sqlite3_error_category(), sqlite3_errstr(rc));
+	}
+
+	::sqlite3* m_destination;
+	sqlite3_backup* m_backup;
+	int m_lastRemaining;
+	std::uint64_t m_pagesCopied;
+	unsigned m_restarts;
+	int m_pageSize;
+	bool m_busy;
+	std::chrono::steady_clock::time_point m_start;
+};
+
+// Copies a live database into a file (created or overwritten).
+inline void backup_to_file(::sqlite3* source, const char* filename, const backup_options& options = backup_options(), const char* sourceName = "main")
+{
+	connection destination(filename);
+	online_backup(destination.get(), source, "main", sourceName).run(options);
+}
+
+// The sqlite3_snapshot functions exist only in SQLite libraries built with
+// SQLITE_ENABLE_SNAPSHOT, which the application has to define to match.
+#ifdef SQLITE_ENABLE_SNAPSHOT
+
+// A point-in-time view of a WAL database that other connections can read
+// without copying. The capturing connection keeps a read transaction
+// open until release_pin() (or destruction), which stops checkpoints from
+// overwriting the frames the snapshot refers to.
+class wal_snapshot
+{
+public:
+	explicit wal_snapshot(::sqlite3* db, const char* schema = "main")
+		: m_db(db), m_schema(schema), m_snapshot(), m_pinned(false)
+	{
+		if (sqlite3_get_autocommit(db) != 0)
+		{
+			throw_if_error(sqlite3_exec(db, "BEGIN", nullptr, nullptr, nullptr), db);
+			m_pinned = true;
+		}
+		// Reading the schema starts the read transaction.
+		int rc = sqlite3_exec(db, ("SELECT 1 FROM \"" + m_schema + "\".sqlite_master LIMIT 1").c_str(), nullptr, nullptr, nullptr);
+		if (rc == SQLITE_OK)
+			rc = sqlite3_snapshot_get(db, m_schema.c_str(), &m_snapshot);
+		if (rc != SQLITE_OK)
+		{
+			release_pin();
+			throw std::system_error(rc, sqlite3_error_category(), sqlite3_errstr(rc));
+		}
+	}
+
+	wal_snapshot(const wal_snapshot&) = delete;
+	wal_snapshot& operator=(const wal_snapshot&) = delete;
+
+	~wal_snapshot()
+	{
+		if (m_snapshot != nullptr)
+			sqlite3_snapshot_free(m_snapshot);
+		release_pin();
+	}
+
+	// Ends the read transaction started by the constructor. Opening the
+	// snapshot may then fail with SQLITE_ERROR_SNAPSHOT once the WAL is
+	// checkpointed and restarted.
+	void release_pin() noexcept
+	{
+		if (m_pinned)
+			sqlite3_exec(m_db, "COMMIT", nullptr, nullptr, nullptr);
+		m_pinned = false;
+	}
+
+	const std::string& schema() const noexcept { return m_schema; }
+	sqlite3_snapshot* get() const noexcept { return m_snapshot; }
+
+	// Orders two snapshots of the same database: <0 if this one is older.
+	int compare(const wal_snapshot& y) const noexcept
+	{
+		return sqlite3_snapshot_cmp(m_snapshot, y.m_snapshot);
+	}
+
+private:
+	::sqlite3* m_db;
+	std::string m_schema;
+	sqlite3_snapshot* m_snapshot;
+	bool m_pinned;
+};
+
+// A read transaction on reader positioned at a wal_snapshot; the reader
+// must be in autocommit mode. Ends the transaction on destruction.
+class snapshot_transaction
+{
+public:
+	snapshot_transaction(::sqlite3* reader, const wal_snapshot& snapshot)
+		: m_db(reader)
+	{
+		throw_if_error(sqlite3_exec(reader, "BEGIN", nullptr, nullptr, nullptr), reader);
+		int rc = sqlite3_snapshot_open(reader, snapshot.schema().c_str(), snapshot.get());
+		if (rc != SQLITE_OK)
+		{
+			sqlite3_exec(reader, "ROLLBACK", nullptr, nullptr, nullptr);
+			throw std::system_error(rc, sqlite3_error_category(), sqlite3_errstr(rc));
+		}
+	}
+
+	snapshot_transaction(const snapshot_transaction&) = delete;
+	snapshot_transaction& operator=(const snapshot_transaction&) = delete;
+
+	~snapshot_transaction()
+	{
+		sqlite3_exec(m_db, "COMMIT", nullptr, nullptr, nullptr);
+	}
+
+private:
+	::sqlite3* m_db;
+};
+
+#endif // SQLITE_ENABLE_SNAPSHOT
+
+} // namespace sqlite3
+} // namespace konata
+
+#endif // KONATA_SQLITE3_BACKUP_HPP
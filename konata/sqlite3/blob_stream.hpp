@@ -0,0 +1,317 @@
+/*
+sqlite3/blob_stream.hpp: Copyright (c) Egtra 2026
+
+Distributed under the Boost Software License, Version 1.0.
+(See accompanying file LICENSE.txt or copy at
+http://www.boost.org/LICENSE_1_0.txt )
+*/
+
+#ifndef KONATA_SQLITE3_BLOB_STREAM_HPP
+#define KONATA_SQLITE3_BLOB_STREAM_HPP
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <ios>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <konata/sqlite3/connection.hpp>
+
+namespace konata
+{
+namespace sqlite3
+{
+
+// Incremental I/O on one BLOB (or TEXT) cell through sqlite3_blob_*, so the
+// value is never materialized as a whole. The size of the cell is fixed
+// while it is open; to store a large value, insert zeroblob(n) first.
+// If the row is modified or deleted through another statement, the
+// handle expires and every operation fails with SQLITE_ABORT until
+// reopen() moves it to a row again.
+class blob_stream
+{
+public:
+	blob_stream() noexcept : m_blob(), m_db(), m_position(0), m_writable() {}
+
+	blob_stream(::sqlite3* db, const char* table, const char* column, sqlite3_int64 rowid, bool writable = false, const char* database = "main")
+		: m_blob(), m_db(), m_position(0), m_writable()
+	{
+		open(db, table, column, rowid, writable, database);
+	}
+
+	blob_stream(blob_stream&& y) noexcept
+		: m_blob(), m_db(), m_position(0), m_writable()
+	{
+		swap(y);
+	}
+
+	blob_stream& operator=(blob_stream&& y) noexcept
+	{
+		blob_stream(std::move(y)).swap(*this);
+		return *this;
+	}
+
+	blob_stream(const blob_stream&) = delete;
+	blob_stream& operator=(const blob_stream&) = delete;
+
+	~blob_stream()
+	{
+		close();
+	}
+
+	void open(::sqlite3* db, const char* table, const char* column, sqlite3_int64 rowid, bool writable = false, const char* database = "main")
+	{
+		close();
+		sqlite3_blob* blob = nullptr;
+		int rc = sqlite3_blob_open(db, database, table, column, rowid, writable ? 1 : 0, &blob);
+		if (rc != SQLITE_OK)
+		{
+			sqlite3_blob_close(blob);
+			throw_if_error(rc, db);
+		}
+		m_blob = blob;
+		m_db = db;
+		m_database = database;
+		m_table = table;
+		m_column = column;
+		m_writable = writable;
+	}
+
+	// Moves to another row of the same table and column without preparing
+	// a new handle. SQLite refuses to reuse an expired handle, so that case
+	// falls back to opening a new one.
+	void reopen(sqlite3_int64 rowid)
+	{
+		m_position = 0;
+		int rc = sqlite3_blob_reopen(m_blob, rowid);
+		if (rc == SQLITE_ABORT)
+		{
+			std::string database = m_database;
+			std::string table = m_table;
+			std::string column = m_column;
+			open(m_db, table.c_str(), column.c_str(), rowid, m_writable, database.c_str());
+			return;
+		}
+		throw_if_error(rc, m_db);
+	}
+
+	void close() noexcept
+	{
+		if (m_blob != nullptr)
+			sqlite3_blob_close(m_blob);
+		m_blob = nullptr;
+		m_position = 0;
+	}
+
+	void swap(blob_stream& y) noexcept
+	{
+		std::swap(m_blob, y.m_blob);
+		std::swap(m_db, y.m_db);
+		std::swap(m_position, y.m_position);
+		m_database.swap(y.m_database);
+		m_table.swap(y.m_table);
+		m_column.swap(y.m_column);
+		std::swap(m_writable, y.m_writable);
+	}
+
+	std::size_t size() const noexcept
+	{
+		return m_blob != nullptr ? static_cast<std::size_t>(sqlite3_blob_bytes(m_blob)) : 0;
+	}
+
+	std::size_t tell() const noexcept { return m_position; }
+
+	void seek(std::size_t position)
+	{
+		if (position > size())
+		{
+			read_at(0, nullptr, 0);
+			throw std::out_of_range("konata::sqlite3::blob_stream::seek");
+		}
+		m_position = position;
+	}
+
+	// Reads up to n bytes from the current position; returns the number
+	// read, which is less than n only at the end of the cell.
+	std::size_t read(void* buffer, std::size_t n)
+	{
+		auto size = this->size();
+		n = m_position < size ? std::min(n, size - m_position) : 0;
+		// An expired handle reports size 0; the empty read at offset 0
+		// surfaces SQLITE_ABORT instead of a silent end of data.
+		read_at(n != 0 ? m_position : 0, buffer, n);
+		m_position += n;
+		return n;
+	}
+
+	// Writes n bytes at the current position; the cell cannot grow.
+	void write(const void* buffer, std::size_t n)
+	{
+		write_at(m_position, buffer, n);
+		m_position += n;
+	}
+
+	void read_at(std::size_t offset, void* buffer, std::size_t n)
+	{
+		throw_if_error(sqlite3_blob_read(m_blob, buffer, static_cast<int>(n), static_cast<int>(offset)), m_db);
+	}
+
+	void write_at(std::size_t offset, const void* buffer, std::size_t n)
+	{
+		throw_if_error(sqlite3_blob_write(m_blob, buffer, static_cast<int>(n), static_cast<int>(offset)), m_db);
+	}
+
+	explicit operator bool() const noexcept { return m_blob != nullptr; }
+	sqlite3_blob* get() const noexcept { return m_blob; }
+
+private:
+	sqlite3_blob* m_blob;
+	::sqlite3* m_db;
+	std::size_t m_position;
+	// For reopening an expired handle.
+	std::string m_database;
+	std::string m_table;
+	std::string m_column;
+	bool m_writable;
+};
+
+// std::streambuf over a blob_stream, moving data in chunks of the buffer
+// size, e.g. std::istream in(&buf); in >> ...; or out << &buf.
+// iostreams turn the std::system_error thrown by a failed chunk into
+// badbit unless the stream has badbit in exceptions(); error() keeps the
+// code either way.
+class blob_streambuf : public std::streambuf
+{
+public:
+	explicit blob_streambuf(blob_stream& blob, std::size_t bufferSize = 64 * 1024)
+		: m_blob(&blob), m_buffer(bufferSize != 0 ? bufferSize : 1), m_bufferStart(blob.tell())
+	{
+	}
+
+	~blob_streambuf()
+	{
+		try
+		{
+			flush_put();
+		}
+		catch (...)
+		{
+		}
+	}
+
+	const std::error_code& error() const noexcept { return m_error; }
+
+protected:
+	int_type underflow() override
+	{
+		flush_put();
+		std::size_t position = get_position();
+		std::size_t n = 0;
+		guard([&] { m_blob->seek(position); n = m_blob->read(m_buffer.data(), m_buffer.size()); });
+		m_bufferStart = position;
+		setg(m_buffer.data(), m_buffer.data(), m_buffer.data() + n);
+		return n != 0 ? traits_type::to_int_type(*gptr()) : traits_type::eof();
+	}
+
+	int_type overflow(int_type c) override
+	{
+		flush_put();
+		// Start a put area at the current position, bounded by the cell size.
+		std::size_t position = get_position();
+		setg(nullptr, nullptr, nullptr);
+		m_bufferStart = position;
+		std::size_t size = m_blob->size();
+		std::size_t n = position < size ? std::min(m_buffer.size(), size - position) : 0;
+		setp(m_buffer.data(), m_buffer.data() + n);
+		if (traits_type::eq_int_type(c, traits_type::eof()))
+			return traits_type::not_eof(c);
+		if (n == 0)
+			return traits_type::eof(); // end of the cell
+		*pptr() = traits_type::to_char_type(c);
+		pbump(1);
+		return c;
+	}
+
+	int sync() override
+	{
+		flush_put();
+		return 0;
+	}
+
+	pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override
+	{
+		flush_put();
+		off_type base = dir == std::ios_base::beg ? 0
+			: dir == std::ios_base::cur ? static_cast<off_type>(get_position())
+			: static_cast<off_type>(m_blob->size());
+		return seekpos(pos_type(base + off), which);
+	}
+
+	pos_type seekpos(pos_type pos, std::ios_base::openmode) override
+	{
+		flush_put();
+		off_type p = pos;
+		if (p < 0 || static_cast<std::size_t>(p) > m_blob->size())
+			return pos_type(off_type(-1));
+		setg(nullptr, nullptr, nullptr);
+		m_bufferStart = static_cast<std::size_t>(p);
+		return pos;
+	}
+
+	std::streamsize showmanyc() override
+	{
+		std::size_t position = get_position();
+		std::size_t size = m_blob->size();
+		return position < size ? static_cast<std::streamsize>(size - position) : -1;
+	}
+
+private:
+	// Position of the next character to read, with no pending put area.
+	std::size_t get_position() const noexcept
+	{
+		return m_bufferStart + static_cast<std::size_t>(gptr() - eback());
+	}
+
+	template<typename F>
+	void guard(F f)
+	{
+		try
+		{
+			f();
+		}
+		catch (const std::system_error& e)
+		{
+			m_error = e.code();
+			throw;
+		}
+	}
+
+	// Writes the pending put area back and leaves the buffer empty.
+	void flush_put()
+	{
+		if (pbase() == nullptr)
+			return;
+		std::size_t n = static_cast<std::size_t>(pptr() - pbase());
+		std::size_t start = m_bufferStart;
+		setp(nullptr, nullptr);
+		m_bufferStart = start + n;
+		guard([&] { m_blob->seek(start); m_blob->write(m_buffer.data(), n); });
+	}
+
+	blob_stream* m_blob;
+	std::vector<char> m_buffer;
+	std::size_t m_bufferStart; // blob offset of m_buffer[0]
+	std::error_code m_error;
+};
+
+} // namespace sqlite3
+} // namespace konata
+
+#endif // KONATA_SQLITE3_BLOB_STREAM_HPP
@@ -0,0 +1,332 @@
+/*
+sqlite3/bulk_insert.hpp: Copyright (c) Egtra 2026
+
+Distributed under the Boost Software License, Version 1.0.
+(See accompanying file LICENSE.txt or copy at
+http://www.boost.org/LICENSE_1_0.txt )
+*/
+
+#ifndef KONATA_SQLITE3_BULK_INSERT_HPP
+#define KONATA_SQLITE3_BULK_INSERT_HPP
+
+#pragma once
+
+// Requires C++14.
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <konata/sqlite3/connection.hpp>
+
+namespace konata
+{
+namespace sqlite3
+{
+
+namespace detail
+{
+
+inline int bind_value(sqlite3_stmt* stmt, int index, std::nullptr_t) noexcept
+{
+	return sqlite3_bind_null(stmt, index);
+}
+
+template<typename T>
+typename std::enable_if<std::is_integral<T>::value, int>::type
+bind_value(sqlite3_stmt* stmt, int index, T value) noexcept
+{
+	return sqlite3_bind_int64(stmt, index, static_cast<sqlite3_int64>(value));
+}
+
+template<typename T>
+typename std::enable_if<std::is_floating_point<T>::value, int>::type
+bind_value(sqlite3_stmt* stmt, int index, T value) noexcept
+{
+	return sqlite3_bind_double(stmt, index, static_cast<double>(value));
+}
+
+// Rows stay alive until the statement has been stepped, so text need not be copied.
+inline int bind_value(sqlite3_stmt* stmt, int index, const char* value) noexcept
+{
+	return sqlite3_bind_text(stmt, index, value, -1, SQLITE_STATIC);
+}
+
+inline int bind_value(sqlite3_stmt* stmt, int index, const std::string& value) noexcept
+{
+	return sqlite3_bind_text(stmt, index, value.data(), static_cast<int>(value.size()), SQLITE_STATIC);
+}
+
+template<typename Tuple, std::size_t... I>
+int bind_tuple(sqlite3_stmt* stmt, int first, const Tuple& row, std::index_sequence<I...>) noexcept
+{
+	int rc = SQLITE_OK;
+	int results[] = { SQLITE_OK, (rc == SQLITE_OK ? (rc = bind_value(stmt, first + static_cast<int>(I), std::get<I>(row))) : rc)... };
+	(void)results;
+	return rc;
+}
+
+template<typename Tuple>
+int bind_tuple(sqlite3_stmt* stmt, int first, const Tuple& row) noexcept
+{
+	return bind_tuple(stmt, first, row, std::make_index_sequence<std::tuple_size<Tuple>::value>());
+}
+
+} // namespace detail
+
+struct bulk_insert_options
+{
+	// Rows written per transaction (SAVEPOINT ... RELEASE).
+	std::size_t rows_per_transaction = 10000;
+	// Upper bound of rows per INSERT statement; 0 means as many as
+	// SQLITE_LIMIT_VARIABLE_NUMBER allows.
+	std::size_t max_rows_per_statement = 0;
+};
+
+// Inserts a forward range of std::tuple rows into a table with multi-row
+// INSERT ... VALUES (...),(...) statements. The table and column names are
+// pasted into the SQL text as given.
+// The prepared statements are kept and reused across chunks and calls.
+template<typename Tuple>
+class bulk_inserter
+{
+public:
+	static const std::size_t column_count = std::tuple_size<Tuple>::value;
+
+	bulk_inserter(::sqlite3* db, std::string table, std::vector<std::string> columns, bulk_insert_options options = bulk_insert_options())
+		: m_db(db), m_table(std::move(table)), m_columns(std::move(columns)), m_options(options), m_rowsPerStatement(), m_tailRows()
+	{
+		if (m_columns.size() != column_count)
+			throw std::invalid_argument("bulk_inserter: column count does not match the tuple size");
+	}
+
+	// Returns the first error; committed receives the number of rows whose
+	// transaction was released (committed, unless the caller holds an outer
+	// transaction). On failure the transaction in progress is rolled back, so
+	// committed is a multiple of rows_per_transaction unless the whole range
+	// succeeded.
+	template<typename Range>
+	std::error_code insert(const Range& rows, std::size_t& committed) noexcept
+	{
+		// Rows are bound a statement's worth at a time, after the iterator has
+		// moved on, so they must live in the range itself.
+		typedef decltype(*std::begin(rows)) reference;
+		static_assert(std::is_lvalue_reference<reference>::value
+			&& std::is_same<typename std::decay<reference>::type, Tuple>::value,
+			"bulk_inserter::insert: the range must yield lvalues of the row tuple type");
+		committed = 0;
+		try
+		{
+			int rc = prepare();
+			if (rc != SQLITE_OK)
+				return make_error_code_from_result(rc);
+
+			std::vector<const Tuple*> pending;
+			pending.reserve(m_rowsPerStatement);
+			std::size_t inTransaction = 0;
+			bool open = false;
+			for (const Tuple& row : rows)
+			{
+				if (!open)
+				{
+					if ((rc = exec("SAVEPOINT konata_bulk_insert")) != SQLITE_OK)
+						return make_error_code_from_result(rc);
+					open = true;
+				}
+				pending.push_back(&row);
+				++inTransaction;
+				if (pending.size() == m_rowsPerStatement || inTransaction == m_options.rows_per_transaction)
+				{
+					if ((rc = flush(pending)) != SQLITE_OK)
+						return rollback(rc);
+				}
+				if (inTransaction == m_options.rows_per_transaction)
+				{
+					if ((rc = exec("RELEASE konata_bulk_insert")) != SQLITE_OK)
+						return rollback(rc);
+					open = false;
+					committed += inTransaction;
+					inTransaction = 0;
+				}
+			}
+			if (open)
+			{
+				if ((rc = flush(pending)) != SQLITE_OK)
+					return rollback(rc);
+				if ((rc = exec("RELEASE konata_bulk_insert")) != SQLITE_OK)
+					return rollback(rc);
+				committed += inTransaction;
+			}
+			return std::error_code();
+		}
+		catch (const std::system_error& e)
+		{
+			abandon();
+			return e.code();
+		}
+		catch (const std::bad_alloc&)
+		{
+			abandon();
+			return make_error_code_from_result(SQLITE_NOMEM);
+		}
+		catch (...)
+		{
+			abandon();
+			return make_error_code_from_result(SQLITE_ERROR);
+		}
+	}
+
+	template<typename Range>
+	std::error_code insert(const Range& rows) noexcept
+	{
+		std::size_t committed;
+		return insert(rows, committed);
+	}
+
+	std::size_t rows_per_statement() const noexcept { return m_rowsPerStatement; }
+
+private:
+	int prepare()
+	{
+		if (m_full)
+			return SQLITE_OK;
+		if (m_options.rows_per_transaction == 0)
+			return SQLITE_MISUSE;
+		auto limit = static_cast<std::size_t>(sqlite3_limit(m_db, SQLITE_LIMIT_VARIABLE_NUMBER, -1));
+		std::size_t n = column_count == 0 ? 1 : limit / column_count;
+		if (m_options.max_rows_per_statement != 0 && m_options.max_rows_per_statement < n)
+			n = m_options.max_rows_per_statement;
+		if (m_options.rows_per_transaction < n)
+			n = m_options.rows_per_transaction;
+		if (n == 0)
+			return SQLITE_RANGE;
+		int rc = prepare_insert(m_full, n);
+		if (rc == SQLITE_OK)
+			m_rowsPerStatement = n;
+		return rc;
+	}
+
+	int prepare_insert(statement& stmt, std::size_t rows)
+	{
+		std::string row = "(";
+		for (std::size_t i = 0; i < column_count; ++i)
+			row += i == 0 ? "?" : ",?";
+		row += ')';
+
+		std::string sql = "INSERT INTO " + m_table + " (";
+		for (std::size_t i = 0; i < column_count; ++i)
+		{
+			if (i != 0)
+				sql += ',';
+			sql += m_columns[i];
+		}
+		sql += ") VALUES ";
+		sql.reserve(sql.size() + rows * (row.size() + 1));
+		for (std::size_t i = 0; i < rows; ++i)
+		{
+			if (i != 0)
+				sql += ',';
+			sql += row;
+		}
+
+		// Kept for the inserter's lifetime, hence persistent.
+#ifdef SQLITE_PREPARE_PERSISTENT
+		const unsigned int prepFlags = SQLITE_PREPARE_PERSISTENT;
+#else
+		const unsigned int prepFlags = 0;
+#endif
+		sqlite3_stmt* p = nullptr;
+		int rc = prepare_statement(m_db, sql.data(), static_cast<int>(sql.size()), prepFlags, &p);
+		stmt.reset_handle(p);
+		return rc;
+	}
+
+	int flush(std::vector<const Tuple*>& pending)
+	{
+		if (pending.empty())
+			return SQLITE_OK;
+		statement* stmt = &m_full;
+		if (pending.size() != m_rowsPerStatement)
+		{
+			if (pending.size() != m_tailRows)
+			{
+				m_tailRows = 0;
+				int rc = prepare_insert(m_tail, pending.size());
+				if (rc != SQLITE_OK)
+					return rc;
+				m_tailRows = pending.size();
+			}
+			stmt = &m_tail;
+		}
+
+		int index = 1;
+		int rc = SQLITE_OK;
+		for (const Tuple* row : pending)
+		{
+			if ((rc = detail::bind_tuple(stmt->get(), index, *row)) != SQLITE_OK)
+				break;
+			index += static_cast<int>(column_count);
+		}
+		if (rc == SQLITE_OK)
+		{
+			rc = sqlite3_step(stmt->get());
+			if (rc == SQLITE_DONE)
+				rc = SQLITE_OK;
+		}
+		stmt->reset();
+		// Bindings refer to the caller's rows; do not keep them past this call.
+		stmt->clear_bindings();
+		pending.clear();
+		return rc;
+	}
+
+	int exec(const char* sql) noexcept
+	{
+		return sqlite3_exec(m_db, sql, nullptr, nullptr, nullptr);
+	}
+
+	// Rolls back after an exception, if the savepoint is open.
+	void abandon() noexcept
+	{
+		if (sqlite3_get_autocommit(m_db) == 0)
+			rollback(SQLITE_ERROR);
+		for (statement* stmt : { &m_full, &m_tail })
+		{
+			if (stmt->get() != nullptr)
+			{
+				stmt->reset();
+				stmt->clear_bindings();
+			}
+		}
+	}
+
+	std::error_code rollback(int rc) noexcept
+	{
+		exec("ROLLBACK TO konata_bulk_insert");
+		exec("RELEASE konata_bulk_insert");
+		return make_error_code_from_result(rc);
+	}
+
+	::sqlite3* m_db;
+	std::string m_table;
+	std::vector<std::string> m_columns;
+	bulk_insert_options m_options;
+	std::size_t m_rowsPerStatement;
+	std::size_t m_tailRows;
+	statement m_full;
+	statement m_tail;
+};
+
+} // namespace sqlite3
+} // namespace konata
+
+#endif // KONATA_SQLITE3_BULK_INSERT_HPP
@@ -0,0 +1,195 @@
+/*
+sqlite3/busy_retry.hpp: Copyright (c) Egtra 2026
+
+Distributed under the Boost Software License, Version 1.0.
+(See accompanying file LICENSE.txt or copy at
+http://www.boost.org/LICENSE_1_0.txt )
+*/
+
+#ifndef KONATA_SQLITE3_BUSY_RETRY_HPP
+#define KONATA_SQLITE3_BUSY_RETRY_HPP
+
+#pragma once
+
+// Requires C++17.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <system_error>
+#include <thread>
+
+#include <konata/sqlite3/result.hpp>
+
+namespace konata
+{
+namespace sqlite3
+{
+
+struct busy_retry_metrics
+{
+	busy_retry_metrics() noexcept : calls(0), retries(0), gave_up(0), wait_ns(0) {}
+
+	std::atomic<std::uint64_t> calls;   // operations that hit a busy condition at least once
+	std::atomic<std::uint64_t> retries; // waits performed
+	std::atomic<std::uint64_t> gave_up; // operations that returned busy after the policy gave up
+	std::atomic<std::uint64_t> wait_ns; // total time spent sleeping
+};
+
+// Exponential backoff with jitter, bounded by a deadline measured from the
+// first busy result.
+// A policy is any type providing
+//   bool next_delay(unsigned attempt, steady_clock::duration elapsed, steady_clock::duration& delay) const;
+// where attempt starts at 1; returning false gives up.
+struct exponential_backoff
+{
+	std::chrono::microseconds initial_delay = std::chrono::microseconds(100);
+	std::chrono::microseconds max_delay = std::chrono::milliseconds(100);
+	double multiplier = 2.0;
+	// Fraction of each delay that is randomized: delay * (1 - jitter * U[0, 1)).
+	double jitter = 0.5;
+	std::chrono::milliseconds deadline = std::chrono::milliseconds(5000);
+
+	bool next_delay(unsigned attempt, std::chrono::steady_clock::duration elapsed, std::chrono::steady_clock::duration& delay) const
+	{
+		if (elapsed >= deadline)
+			return false;
+		double d = static_cast<double>(initial_delay.count());
+		for (unsigned i = 1; i < attempt && d < max_delay.count(); ++i)
+			d *= multiplier;
+		if (d > max_delay.count())
+			d = static_cast<double>(max_delay.count());
+		thread_local std::minstd_rand engine(static_cast<std::minstd_rand::result_type>(
+			std::hash<std::thread::id>()(std::this_thread::get_id())));
+		d *= 1.0 - jitter * std::uniform_real_distribution<double>(0.0, 1.0)(engine);
+		delay = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::micro>(d));
+		auto remaining = deadline - elapsed;
+		if (delay > remaining)
+			delay = remaining;
+		return true;
+	}
+};
+
+inline bool is_busy(const std::error_code& ec) noexcept
+{
+	return ec == std::errc::device_or_resource_busy;
+}
+
+namespace detail
+{
+
+inline const std::error_code& error_of(const std::error_code& ec) noexcept { return ec; }
+
+template<typename T>
+const std::error_code& error_of(const result<T>& r) noexcept { return r.error(); }
+
+} // namespace detail
+
+// Calls f() until it returns something other than a busy error
+// (SQLITE_BUSY or SQLITE_LOCKED) or the policy gives up. f returns a
+// result<T> or a std::error_code, and must leave the database in a state
+// where calling it again is meaningful (e.g. reset the statement or roll
+// back the transaction it started).
+template<typename Policy, typename F>
+auto retry_on_busy(const Policy& policy, F&& f, busy_retry_metrics* metrics = nullptr) -> decltype(f())
+{
+	auto r = f();
+	if (!is_busy(detail::error_of(r)))
+		return r;
+	if (metrics != nullptr)
+		metrics->calls.fetch_add(1, std::memory_order_relaxed);
+	auto start = std::chrono::steady_clock::now();
+	for (unsigned attempt = 1;; ++attempt)
+	{
+		std::chrono::steady_clock::duration delay;
+		if (!policy.next_delay(attempt, std::chrono::steady_clock::now() - start, delay))
+		{
+			if (metrics != nullptr)
+				metrics->gave_up.fetch_add(1, std::memory_order_relaxed);
+			return r;
+		}
+		auto before = std::chrono::steady_clock::now();
+		std::this_thread::sleep_for(delay);
+		if (metrics != nullptr)
+		{
+			metrics->retries.fetch_add(1, std::memory_order_relaxed);
+			metrics->wait_ns.fetch_add(static_cast<std::uint64_t>(
+				std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - before).count()),
+				std::memory_order_relaxed);
+		}
+		r = f();
+		if (!is_busy(detail::error_of(r)))
+			return r;
+	}
+}
+
+// Applies a policy inside SQLite through sqlite3_busy_handler, so that a
+// statement waits for the lock instead of returning SQLITE_BUSY.
+// One busy_handler serves one connection and must outlive it (or be
+// replaced by another handler). SQLite does not invoke the handler in all
+// cases (e.g. to avoid deadlocks inside a transaction); retry_on_busy
+// covers those.
+template<typename Policy = exponential_backoff>
+class busy_handler
+{
+public:
+	explicit busy_handler(const Policy& policy = Policy(), busy_retry_metrics* metrics = nullptr)
+		: m_policy(policy), m_metrics(metrics) {}
+
+	busy_handler(const busy_handler&) = delete;
+	busy_handler& operator=(const busy_handler&) = delete;
+
+	void install(::sqlite3* db)
+	{
+		throw_if_error(sqlite3_busy_handler(db, &callback, this), db);
+	}
+
+private:
+	static int callback(void* context, int count) noexcept
+	{
+		auto pthis = static_cast<busy_handler*>(context);
+		auto now = std::chrono::steady_clock::now();
+		if (count == 0)
+		{
+			pthis->m_start = now;
+			if (pthis->m_metrics != nullptr)
+				pthis->m_metrics->calls.fetch_add(1, std::memory_order_relaxed);
+		}
+		std::chrono::steady_clock::duration delay;
+		bool retry;
+		try
+		{
+			retry = pthis->m_policy.next_delay(static_cast<unsigned>(count) + 1, now - pthis->m_start, delay);
+		}
+		catch (...)
+		{
+			retry = false;
+		}
+		if (!retry)
+		{
+			if (pthis->m_metrics != nullptr)
+				pthis->m_metrics->gave_up.fetch_add(1, std::memory_order_relaxed);
+			return 0;
+		}
+		std::this_thread::sleep_for(delay);
+		if (pthis->m_metrics != nullptr)
+		{
+			pthis->m_metrics->retries.fetch_add(1, std::memory_order_relaxed);
+			pthis->m_metrics->wait_ns.fetch_add(static_cast<std::uint64_t>(
+				std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - now).count()),
+				std::memory_order_relaxed);
+		}
+		return 1;
+	}
+
+	Policy m_policy;
+	busy_retry_metrics* m_metrics;
+	std::chrono::steady_clock::time_point m_start;
+};
+
+} // namespace sqlite3
+} // namespace konata
+
+#endif // KONATA_SQLITE3_BUSY_RETRY_HPP
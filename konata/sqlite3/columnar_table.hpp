@@ -0,0 +1,630 @@
+/*
+sqlite3/columnar_table.hpp: Copyright (c) Egtra 2026
+
+Distributed under the Boost Software License, Version 1.0.
+(See accompanying file LICENSE.txt or copy at
+http://www.boost.org/LICENSE_1_0.txt )
+*/
+
+#ifndef KONATA_SQLITE3_COLUMNAR_TABLE_HPP
+#define KONATA_SQLITE3_COLUMNAR_TABLE_HPP
+
+#pragma once
+
+// Requires C++17.
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <konata/sqlite3/connection.hpp>
+
+namespace konata
+{
+namespace sqlite3
+{
+
+enum class column_order
+{
+	unsorted,
+	ascending, // the column is non-decreasing in row order
+};
+
+namespace detail
+{
+
+// vtab_value<T> maps a C++ cell type onto SQLite: its declared type, how to
+// return it from xColumn, and how to compare it with a constraint value.
+// compare() returns false when the value cannot be ordered against T
+// (other storage class, NULL), in which case the table falls back to a scan.
+template<typename T, typename = void>
+struct vtab_value;
+
+template<typename T>
+struct vtab_value<T, typename std::enable_if<std::is_integral<T>::value>::type>
+{
+	static const char* declared_type() noexcept { return "INTEGER"; }
+	static void result(sqlite3_context* ctx, T value, bool) noexcept
+	{
+		sqlite3_result_int64(ctx, static_cast<sqlite3_int64>(value));
+	}
+	static bool compare(T value, sqlite3_value* v, int& order) noexcept
+	{
+		switch (sqlite3_value_type(v))
+		{
+		case SQLITE_INTEGER:
+		{
+			auto x = static_cast<sqlite3_int64>(value);
+			auto y = sqlite3_value_int64(v);
+			order = x < y ? -1 : x > y ? 1 : 0;
+			return true;
+		}
+		case SQLITE_FLOAT:
+		{
+			auto x = static_cast<double>(value);
+			auto y = sqlite3_value_double(v);
+			if (std::isnan(y))
+				return false;
+			order = x < y ? -1 : x > y ? 1 : 0;
+			return true;
+		}
+		default:
+			return false;
+		}
+	}
+};
+
+template<typename T>
+struct vtab_value<T, typename std::enable_if<std::is_floating_point<T>::value>::type>
+{
+	static const char* declared_type() noexcept { return "REAL"; }
+	static void result(sqlite3_context* ctx, T value, bool) noexcept
+	{
+		sqlite3_result_double(ctx, static_cast<double>(value));
+	}
+	static bool compare(T value, sqlite3_value* v, int& order) noexcept
+	{
+		auto type = sqlite3_value_type(v);
+		if (type != SQLITE_INTEGER && type != SQLITE_FLOAT)
+			return false;
+		auto x = static_cast<double>(value);
+		auto y = sqlite3_value_double(v);
+		if (std::isnan(x) || std::isnan(y))
+			return false;
+		order = x < y ? -1 : x > y ? 1 : 0;
+		return true;
+	}
+};
+
+template<>
+struct vtab_value<std::string_view>
+{
+	static const char* declared_type() noexcept { return "TEXT"; }
+	// borrowed: the characters outlive the statement step, so SQLite need
+	// not copy them.
+	static void result(sqlite3_context* ctx, std::string_view value, bool borrowed) noexcept
+	{
+		sqlite3_result_text64(ctx, value.data(), static_cast<sqlite3_uint64>(value.size()),
+			borrowed ? SQLITE_STATIC : SQLITE_TRANSIENT, SQLITE_UTF8);
+	}
+	// BINARY collation.
+	static bool compare(std::string_view value, sqlite3_value* v, int& order) noexcept
+	{
+		if (sqlite3_value_type(v) != SQLITE_TEXT)
+			return false;
+		auto p = reinterpret_cast<const char*>(sqlite3_value_text(v));
+		if (p == nullptr)
+			return false;
+		auto c = value.compare(std::string_view(p, static_cast<std::size_t>(sqlite3_value_bytes(v))));
+		order = c < 0 ? -1 : c > 0 ? 1 : 0;
+		return true;
+	}
+};
+
+template<>
+struct vtab_value<std::string> : vtab_value<std::string_view> {};
+
+template<>
+struct vtab_value<const char*> : vtab_value<std::string_view> {};
+
+template<>
+struct vtab_value<char*> : vtab_value<std::string_view> {};
+
+template<>
+struct vtab_value<blob_view>
+{
+	static const char* declared_type() noexcept { return "BLOB"; }
+	static void result(sqlite3_context* ctx, blob_view value, bool borrowed) noexcept
+	{
+		sqlite3_result_blob64(ctx, value.data(), static_cast<sqlite3_uint64>(value.size()),
+			borrowed ? SQLITE_STATIC : SQLITE_TRANSIENT);
+	}
+	static bool compare(blob_view, sqlite3_value*, int&) noexcept
+	{
+		return false;
+	}
+};
+
+class vtab_column
+{
+public:
+	vtab_column(std::string name, const char* declaredType, column_order order)
+		: m_name(std::move(name)), m_declaredType(declaredType), m_order(order) {}
+	virtual ~vtab_column() = default;
+
+	const std::string& name() const noexcept { return m_name; }
+	const char* declared_type() const noexcept { return m_declaredType; }
+	bool sorted() const noexcept { return m_order == column_order::ascending; }
+
+	virtual void result(sqlite3_context* ctx, std::size_t row) const noexcept = 0;
+	virtual bool compare(std::size_t row, sqlite3_value* v, int& order) const noexcept = 0;
+
+private:
+	std::string m_name;
+	const char* m_declaredType;
+	column_order m_order;
+};
+
+// Reads cell (row) through get(row), which returns a T or a reference to one.
+template<typename Get>
+class vtab_getter_column : public vtab_column
+{
+	typedef decltype(std::declval<const Get&>()(std::size_t())) get_result;
+	typedef typename std::decay<get_result>::type value_type;
+	typedef vtab_value<value_type> traits;
+	// A std::string returned by value dies before SQLite reads it.
+	static constexpr bool borrowed = std::is_reference<get_result>::value || !std::is_same<value_type, std::string>::value;
+
+public:
+	vtab_getter_column(std::string name, column_order order, Get get)
+		: vtab_column(std::move(name), traits::declared_type(), order), m_get(std::move(get)) {}
+
+	void result(sqlite3_context* ctx, std::size_t row) const noexcept override
+	{
+		traits::result(ctx, convert(m_get(row)), borrowed);
+	}
+
+	bool compare(std::size_t row, sqlite3_value* v, int& order) const noexcept override
+	{
+		return traits::compare(convert(m_get(row)), v, order);
+	}
+
+private:
+	template<typename T>
+	static decltype(auto) convert(const T& value) noexcept
+	{
+		if constexpr (std::is_same<T, std::string>::value)
+			return std::string_view(value);
+		else if constexpr (std::is_same<T, const char*>::value || std::is_same<T, char*>::value)
+			return value != nullptr ? std::string_view(value) : std::string_view();
+		else
+			return value;
+	}
+
+	Get m_get;
+};
+
+} // namespace detail
+
+// An eponymous, read-only virtual table over data owned by the caller.
+// Cells are handed to SQLite without copying, so the data (and this
+// object) must stay unchanged and alive while the connection uses the
+// table; define all columns before register_module().
+//   struct_table<item> t(items);
+//   t.column("id", &item::id, column_order::ascending).column("name", &item::name);
+//   t.register_module(db, "items"); // SELECT * FROM items WHERE id BETWEEN 10 AND 20
+// Equality and range constraints on ascending columns become binary
+// searches; SQLite still re-checks every constraint, so constraint values
+// of another type or collation only cost a wider scan.
+class columnar_table
+{
+public:
+	columnar_table(const columnar_table&) = delete;
+	columnar_table& operator=(const columnar_table&) = delete;
+	virtual ~columnar_table() = default;
+
+	virtual std::size_t row_count() const noexcept = 0;
+
+	int column_count() const noexcept { return static_cast<int>(m_columns.size()); }
+
+	void register_module(::sqlite3* db, const char* name)
+	{
+		throw_if_error(sqlite3_create_module_v2(db, name, &module(), this, nullptr), db);
+	}
+
+protected:
+	columnar_table() = default;
+
+	void add_column(std::unique_ptr<detail::vtab_column> column)
+	{
+		if (column_count() >= max_columns)
+			throw std::invalid_argument("konata::sqlite3::columnar_table: too many columns");
+		m_columns.push_back(std::move(column));
+	}
+
+private:
+	// idxNum = column << 5 | constraint flags; argv follows the flag order.
+	enum : int
+	{
+		index_eq = 1,
+		index_gt = 2,
+		index_ge = 4,
+		index_lt = 8,
+		index_le = 16,
+		index_shift = 5,
+		max_columns = 1 << 20,
+	};
+
+	struct table_vtab
+	{
+		sqlite3_vtab base;
+		columnar_table* table;
+	};
+
+	struct cursor
+	{
+		sqlite3_vtab_cursor base;
+		columnar_table* table;
+		std::size_t row;
+		std::size_t end;
+	};
+
+	static columnar_table& table_of(sqlite3_vtab* vtab) noexcept
+	{
+		return *reinterpret_cast<table_vtab*>(vtab)->table;
+	}
+
+	static cursor& cursor_of(sqlite3_vtab_cursor* cur) noexcept
+	{
+		return *reinterpret_cast<cursor*>(cur);
+	}
+
+	static void append_identifier(std::string& s, const std::string& name)
+	{
+		s += '"';
+		for (char c : name)
+		{
+			if (c == '"')
+				s += '"';
+			s += c;
+		}
+		s += '"';
+	}
+
+	static int x_connect(::sqlite3* db, void* aux, int, const char* const*, sqlite3_vtab** out, char** err) noexcept
+	{
+		auto table = static_cast<columnar_table*>(aux);
+		try
+		{
+			std::string sql = "CREATE TABLE x(";
+			for (std::size_t i = 0; i < table->m_columns.size(); ++i)
+			{
+				if (i != 0)
+					sql += ", ";
+				append_identifier(sql, table->m_columns[i]->name());
+				sql += ' ';
+				sql += table->m_columns[i]->declared_type();
+			}
+			sql += ')';
+			int rc = sqlite3_declare_vtab(db, sql.c_str());
+			if (rc != SQLITE_OK)
+			{
+				*err = sqlite3_mprintf("%s", sqlite3_errmsg(db));
+				return rc;
+			}
+		}
+		catch (const std::bad_alloc&)
+		{
+			return SQLITE_NOMEM;
+		}
+		auto vtab = static_cast<table_vtab*>(sqlite3_malloc(sizeof(table_vtab)));
+		if (vtab == nullptr)
+			return SQLITE_NOMEM;
+		std::memset(vtab, 0, sizeof(table_vtab));
+		vtab->table = table;
+		*out = &vtab->base;
+		return SQLITE_OK;
+	}
+
+	static int x_disconnect(sqlite3_vtab* vtab) noexcept
+	{
+		sqlite3_free(vtab);
+		return SQLITE_OK;
+	}
+
+	static bool uses_binary_collation(sqlite3_index_info* info, int constraint) noexcept
+	{
+#if SQLITE_VERSION_NUMBER >= 3022000
+		auto collation = sqlite3_vtab_collation(info, constraint);
+		return collation == nullptr || sqlite3_stricmp(collation, "BINARY") == 0;
+#else
+		(void)info;
+		(void)constraint;
+		return true;
+#endif
+	}
+
+	static int x_best_index(sqlite3_vtab* vtab, sqlite3_index_info* info) noexcept
+	{
+		auto& table = table_of(vtab);
+		auto rows = static_cast<double>(table.row_count());
+		auto search = std::log2(rows + 1.0) + 1.0;
+
+		// Pick the sorted column with the most selective usable constraints.
+		int bestColumn = -1;
+		int bestFlags = 0;
+		for (int i = 0; i < info->nConstraint; ++i)
+		{
+			const auto& c = info->aConstraint[i];
+			if (!c.usable || c.iColumn < 0 || !table.m_columns[static_cast<std::size_t>(c.iColumn)]->sorted())
+				continue;
+			int flag = 0;
+			switch (c.op)
+			{
+			case SQLITE_INDEX_CONSTRAINT_EQ: flag = index_eq; break;
+			case SQLITE_INDEX_CONSTRAINT_GT: flag = index_gt; break;
+			case SQLITE_INDEX_CONSTRAINT_GE: flag = index_ge; break;
+			case SQLITE_INDEX_CONSTRAINT_LT: flag = index_lt; break;
+			case SQLITE_INDEX_CONSTRAINT_LE: flag = index_le; break;
+			default: continue;
+			}
+			if (!uses_binary_collation(info, i))
+				continue;
+			if (c.iColumn == bestColumn)
+			{
+				bestFlags |= flag;
+			}
+			else
+			{
+				auto score = [](int flags) { return (flags & index_eq) != 0 ? 3 : (flags & (index_gt | index_ge)) != 0 && (flags & (index_lt | index_le)) != 0 ? 2 : flags != 0 ? 1 : 0; };
+				if (score(flag) > score(bestFlags))
+				{
+					bestColumn = c.iColumn;
+					bestFlags = flag;
+				}
+			}
+		}
+
+		// Keep one constraint per direction; EQ makes the others redundant.
+		if ((bestFlags & index_eq) != 0)
+			bestFlags = index_eq;
+		if ((bestFlags & index_gt) != 0)
+			bestFlags &= ~index_ge;
+		if ((bestFlags & index_lt) != 0)
+			bestFlags &= ~index_le;
+
+		int argc = 0;
+		for (int flag = index_eq; flag <= index_le; flag <<= 1)
+		{
+			if ((bestFlags & flag) == 0)
+				continue;
+			++argc;
+			for (int i = 0; i < info->nConstraint; ++i)
+			{
+				const auto& c = info->aConstraint[i];
+				int op = flag == index_eq ? SQLITE_INDEX_CONSTRAINT_EQ
+					: flag == index_gt ? SQLITE_INDEX_CONSTRAINT_GT
+					: flag == index_ge ? SQLITE_INDEX_CONSTRAINT_GE
+					: flag == index_lt ? SQLITE_INDEX_CONSTRAINT_LT
+					: SQLITE_INDEX_CONSTRAINT_LE;
+				if (c.usable && c.iColumn == bestColumn && c.op == op && uses_binary_collation(info, i))
+				{
+					info->aConstraintUsage[i].argvIndex = argc;
+					info->aConstraintUsage[i].omit = 0;
+					break;
+				}
+			}
+		}
+
+		double estimate = rows;
+		if ((bestFlags & index_eq) != 0)
+			estimate = 1.0;
+		else if ((bestFlags & (index_gt | index_ge)) != 0 && (bestFlags & (index_lt | index_le)) != 0)
+			estimate = rows / 16.0;
+		else if (bestFlags != 0)
+			estimate = rows / 4.0;
+		info->idxNum = bestColumn < 0 ? 0 : (bestColumn << index_shift) | bestFlags;
+		info->estimatedCost = bestFlags != 0 ? search + estimate : rows;
+#if SQLITE_VERSION_NUMBER >= 3008002
+		info->estimatedRows = static_cast<sqlite3_int64>(estimate);
+#endif
+
+		// Rows come out in storage order, which every ascending column follows.
+		bool ordered = info->nOrderBy > 0;
+		for (int i = 0; i < info->nOrderBy; ++i)
+		{
+			const auto& o = info->aOrderBy[i];
+			if (o.desc || o.iColumn < 0 || !table.m_columns[static_cast<std::size_t>(o.iColumn)]->sorted())
+				ordered = false;
+		}
+		info->orderByConsumed = ordered;
+		return SQLITE_OK;
+	}
+
+	static int x_open(sqlite3_vtab* vtab, sqlite3_vtab_cursor** out) noexcept
+	{
+		auto cur = static_cast<cursor*>(sqlite3_malloc(sizeof(cursor)));
+		if (cur == nullptr)
+			return SQLITE_NOMEM;
+		std::memset(cur, 0, sizeof(cursor));
+		cur->table = &table_of(vtab);
+		*out = &cur->base;
+		return SQLITE_OK;
+	}
+
+	static int x_close(sqlite3_vtab_cursor* cur) noexcept
+	{
+		sqlite3_free(cur);
+		return SQLITE_OK;
+	}
+
+	// First row in [first, last) for which the column compares at least
+	// (strict: above) the value; false if the value is not comparable.
+	static bool lower_bound(const detail::vtab_column& column, std::size_t first, std::size_t last, sqlite3_value* v, bool strict, std::size_t& out) noexcept
+	{
+		while (first < last)
+		{
+			auto mid = first + (last - first) / 2;
+			int order;
+			if (!column.compare(mid, v, order))
+				return false;
+			if (order < 0 || (strict && order == 0))
+				first = mid + 1;
+			else
+				last = mid;
+		}
+		out = first;
+		return true;
+	}
+
+	static int x_filter(sqlite3_vtab_cursor* cur, int idxNum, const char*, int argc, sqlite3_value** argv) noexcept
+	{
+		auto& c = cursor_of(cur);
+		auto& table = *c.table;
+		std::size_t first = 0;
+		std::size_t last = table.row_count();
+		int flags = idxNum & ((1 << index_shift) - 1);
+		if (flags != 0)
+		{
+			const auto& column = *table.m_columns[static_cast<std::size_t>(idxNum >> index_shift)];
+			std::size_t lo = first;
+			std::size_t hi = last;
+			bool ok = true;
+			int arg = 0;
+			if ((flags & index_eq) != 0 && arg < argc)
+			{
+				ok = lower_bound(column, first, last, argv[arg], false, lo)
+					&& lower_bound(column, lo, last, argv[arg], true, hi);
+				++arg;
+			}
+			if (ok && (flags & (index_gt | index_ge)) != 0 && arg < argc)
+				ok = lower_bound(column, first, last, argv[arg++], (flags & index_gt) != 0, lo);
+			if (ok && (flags & (index_lt | index_le)) != 0 && arg < argc)
+				ok = lower_bound(column, first, last, argv[arg++], (flags & index_le) != 0, hi);
+			if (ok)
+			{
+				first = lo;
+				last = hi < lo ? lo : hi;
+			}
+		}
+		c.row = first;
+		c.end = last;
+		return SQLITE_OK;
+	}
+
+	static int x_next(sqlite3_vtab_cursor* cur) noexcept
+	{
+		++cursor_of(cur).row;
+		return SQLITE_OK;
+	}
+
+	static int x_eof(sqlite3_vtab_cursor* cur) noexcept
+	{
+		auto& c = cursor_of(cur);
+		return c.row >= c.end;
+	}
+
+	static int x_column(sqlite3_vtab_cursor* cur, sqlite3_context* ctx, int column) noexcept
+	{
+		auto& c = cursor_of(cur);
+		c.table->m_columns[static_cast<std::size_t>(column)]->result(ctx, c.row);
+		return SQLITE_OK;
+	}
+
+	static int x_rowid(sqlite3_vtab_cursor* cur, sqlite3_int64* rowid) noexcept
+	{
+		*rowid = static_cast<sqlite3_int64>(cursor_of(cur).row);
+		return SQLITE_OK;
+	}
+
+	static const sqlite3_module& module() noexcept
+	{
+		static const sqlite3_module m = []
+		{
+			sqlite3_module m = {};
+			// xCreate == nullptr: eponymous-only, usable without CREATE VIRTUAL TABLE.
+			m.xConnect = &x_connect;
+			m.xBestIndex = &x_best_index;
+			m.xDisconnect = &x_disconnect;
+			m.xDestroy = &x_disconnect;
+			m.xOpen = &x_open;
+			m.xClose = &x_close;
+			m.xFilter = &x_filter;
+			m.xNext = &x_next;
+			m.xEof = &x_eof;
+			m.xColumn = &x_column;
+			m.xRowid = &x_rowid;
+			return m;
+		}();
+		return m;
+	}
+
+	std::vector<std::unique_ptr<detail::vtab_column>> m_columns;
+};
+
+// Exposes a std::vector of structs; columns are data members or callables
+// taking const Row&. The vector may be replaced between queries.
+template<typename Row>
+class struct_table : public columnar_table
+{
+public:
+	explicit struct_table(const std::vector<Row>& rows) : m_rows(&rows) {}
+
+	std::size_t row_count() const noexcept override { return m_rows->size(); }
+
+	template<typename F>
+	struct_table& column(std::string name, F f, column_order order = column_order::unsorted)
+	{
+		auto rows = m_rows;
+		auto get = [rows, f](std::size_t row) -> decltype(auto) { return std::invoke(f, (*rows)[row]); };
+		add_column(std::make_unique<detail::vtab_getter_column<decltype(get)>>(std::move(name), order, std::move(get)));
+		return *this;
+	}
+
+private:
+	const std::vector<Row>* m_rows;
+};
+
+// Exposes parallel column arrays of equal length.
+class array_table : public columnar_table
+{
+public:
+	array_table() : m_size(0) {}
+
+	std::size_t row_count() const noexcept override { return m_size; }
+
+	template<typename T>
+	array_table& column(std::string name, const T* data, std::size_t size, column_order order = column_order::unsorted)
+	{
+		if (column_count() != 0 && size != m_size)
+			throw std::invalid_argument("konata::sqlite3::array_table: column length mismatch");
+		auto get = [data](std::size_t row) -> const T& { return data[row]; };
+		add_column(std::make_unique<detail::vtab_getter_column<decltype(get)>>(std::move(name), order, std::move(get)));
+		m_size = size;
+		return *this;
+	}
+
+	template<typename T>
+	array_table& column(std::string name, const std::vector<T>& data, column_order order = column_order::unsorted)
+	{
+		return column(std::move(name), data.data(), data.size(), order);
+	}
+
+private:
+	std::size_t m_size;
+};
+
+} // namespace sqlite3
+} // namespace konata
+
+#endif // KONATA_SQLITE3_COLUMNAR_TABLE_HPP
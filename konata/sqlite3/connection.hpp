@@ -0,0 +1,429 @@
+/*
+sqlite3/connection.hpp: Copyright (c) Egtra 2026
+
+Distributed under the Boost Software License, Version 1.0.
+(See accompanying file LICENSE.txt or copy at
+http://www.boost.org/LICENSE_1_0.txt )
+*/
+
+#ifndef KONATA_SQLITE3_CONNECTION_HPP
+#define KONATA_SQLITE3_CONNECTION_HPP
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <system_error>
+#include <utility> // swap
+
+#if __cplusplus >= 201703L || (defined _MSVC_LANG && _MSVC_LANG >= 201703L)
+#include <string_view>
+#define KONATA_SQLITE3_HAS_STRING_VIEW
+#endif
+
+// Verify at step() that buffers bound with SQLITE_STATIC have not changed.
+// Only the checking depends on this: the layout of statement is the same
+// either way, so translation units built with and without NDEBUG can share
+// statements.
+#if !defined KONATA_SQLITE3_CHECK_STATIC_BINDINGS && !defined NDEBUG
+#define KONATA_SQLITE3_CHECK_STATIC_BINDINGS
+#endif
+
+#include <cassert>
+#include <vector>
+
+#include <konata/sqlite3/error_category.hpp>
+
+namespace konata
+{
+namespace sqlite3
+{
+
+inline std::error_code make_error_code_from_result(int rc) noexcept
+{
+	return std::error_code(rc, sqlite3_error_category());
+}
+
+inline bool is_error_result(int rc) noexcept
+{
+	return rc != SQLITE_OK && rc != SQLITE_ROW && rc != SQLITE_DONE;
+}
+
+inline void throw_if_error(int rc)
+{
+	if (is_error_result(rc))
+		throw std::system_error(rc, sqlite3_error_category());
+}
+
+inline void throw_if_error(int rc, ::sqlite3* db)
+{
+	if (is_error_result(rc))
+	{
+		if (db != nullptr)
+			throw std::system_error(rc, sqlite3_error_category(), sqlite3_errmsg(db));
+		else
+			throw std::system_error(rc, sqlite3_error_category());
+	}
+}
+
+// sqlite3_prepare_v3 where available (prepFlags such as
+// SQLITE_PREPARE_PERSISTENT are ignored before 3.20.0).
+inline int prepare_statement(::sqlite3* db, const char* sql, int nbytes, unsigned int prepFlags, sqlite3_stmt** stmt, const char** tail = nullptr) noexcept
+{
+#if SQLITE_VERSION_NUMBER >= 3020000
+	return sqlite3_prepare_v3(db, sql, nbytes, prepFlags, stmt, tail);
+#else
+	(void)prepFlags;
+	return sqlite3_prepare_v2(db, sql, nbytes, stmt, tail);
+#endif
+}
+
+// Bytes of a BLOB column; valid until the next step(), reset() or
+// conversion of the same column.
+struct blob_view
+{
+	const unsigned char* data() const noexcept { return m_data; }
+	std::size_t size() const noexcept { return m_size; }
+	bool empty() const noexcept { return m_size == 0; }
+	const unsigned char* begin() const noexcept { return m_data; }
+	const unsigned char* end() const noexcept { return m_data + m_size; }
+
+	const unsigned char* m_data;
+	std::size_t m_size;
+};
+
+class connection
+{
+public:
+	connection() noexcept : m_db() {}
+	explicit connection(::sqlite3* db) noexcept : m_db(db) {}
+
+	explicit connection(
+		const char* filename,
+		int flags = SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE,
+		const char* vfs = nullptr)
+		: m_db()
+	{
+		open(filename, flags, vfs);
+	}
+
+	connection(connection&& y) noexcept : m_db(y.release()) {}
+
+	connection& operator=(connection&& y) noexcept
+	{
+		reset(y.release());
+		return *this;
+	}
+
+	connection(const connection&) = delete;
+	connection& operator=(const connection&) = delete;
+
+	~connection() { reset(); }
+
+	void open(
+		const char* filename,
+		int flags = SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE,
+		const char* vfs = nullptr)
+	{
+		::sqlite3* db = nullptr;
+		int rc = sqlite3_open_v2(filename, &db, flags, vfs);
+		if (rc != SQLITE_OK)
+		{
+			// sqlite3_open_v2 may allocate a handle even on failure.
+			connection failed(db);
+			throw_if_error(rc, db);
+		}
+		reset(db);
+	}
+
+	void reset(::sqlite3* db = nullptr) noexcept
+	{
+		if (m_db != nullptr)
+			sqlite3_close_v2(m_db);
+		m_db = db;
+	}
+
+	::sqlite3* release() noexcept
+	{
+		::sqlite3* ret = m_db;
+		m_db = nullptr;
+		return ret;
+	}
+
+	void swap(connection& y) noexcept { std::swap(m_db, y.m_db); }
+
+	void exec(const char* sql)
+	{
+		throw_if_error(sqlite3_exec(m_db, sql, nullptr, nullptr, nullptr), m_db);
+	}
+
+	void exec(const std::string& sql) { exec(sql.c_str()); }
+
+	std::int64_t last_insert_rowid() const noexcept { return sqlite3_last_insert_rowid(m_db); }
+	int changes() const noexcept { return sqlite3_changes(m_db); }
+
+	explicit operator bool() const noexcept { return m_db != nullptr; }
+	::sqlite3* get() const noexcept { return m_db; }
+
+private:
+	::sqlite3* m_db;
+};
+
+class statement
+{
+public:
+	statement() noexcept : m_stmt() {}
+	explicit statement(sqlite3_stmt* stmt) noexcept : m_stmt(stmt) {}
+
+	statement(::sqlite3* db, const char* sql, int nbytes = -1)
+		: m_stmt()
+	{
+		prepare(db, sql, nbytes);
+	}
+
+	statement(::sqlite3* db, const std::string& sql)
+		: m_stmt()
+	{
+		prepare(db, sql.data(), static_cast<int>(sql.size()));
+	}
+
+	statement(statement&& y) noexcept : m_stmt() { swap(y); }
+
+	statement& operator=(statement&& y) noexcept
+	{
+		statement(std::move(y)).swap(*this);
+		return *this;
+	}
+
+	statement(const statement&) = delete;
+	statement& operator=(const statement&) = delete;
+
+	~statement() { reset_handle(); }
+
+	void prepare(::sqlite3* db, const char* sql, int nbytes = -1, unsigned int prepFlags = 0)
+	{
+		sqlite3_stmt* stmt = nullptr;
+		int rc = prepare_statement(db, sql, nbytes, prepFlags, &stmt);
+		throw_if_error(rc, db);
+		reset_handle(stmt);
+	}
+
+	// Returns true if a row is available, false when the statement has finished.
+	bool step()
+	{
+		int rc = raw_step();
+		if (rc == SQLITE_ROW)
+			return true;
+		if (rc == SQLITE_DONE)
+			return false;
+		throw_if_error(rc, db_handle());
+		return false;
+	}
+
+	// Returns the sqlite3_step result code without throwing.
+	int raw_step() noexcept
+	{
+#ifdef KONATA_SQLITE3_CHECK_STATIC_BINDINGS
+		check_static_bindings();
+#endif
+		return sqlite3_step(m_stmt);
+	}
+
+	// sqlite3_reset returns the error of the last step; it has been reported by step().
+	void reset() noexcept { (void)sqlite3_reset(m_stmt); }
+	void clear_bindings() noexcept
+	{
+		(void)sqlite3_clear_bindings(m_stmt);
+		m_staticBindings.clear();
+	}
+
+	statement& bind(int index, int value)
+	{
+		return bound(sqlite3_bind_int(m_stmt, index, value), index);
+	}
+	statement& bind(int index, std::int64_t value)
+	{
+		return bound(sqlite3_bind_int64(m_stmt, index, value), index);
+	}
+	statement& bind(int index, double value)
+	{
+		return bound(sqlite3_bind_double(m_stmt, index, value), index);
+	}
+	statement& bind(int index, std::nullptr_t)
+	{
+		return bound(sqlite3_bind_null(m_stmt, index), index);
+	}
+	statement& bind(int index, const char* value)
+	{
+		return bound(sqlite3_bind_text(m_stmt, index, value, -1, SQLITE_TRANSIENT), index);
+	}
+	statement& bind(int index, const std::string& value)
+	{
+		return bound(sqlite3_bind_text(m_stmt, index, value.data(), static_cast<int>(value.size()), SQLITE_TRANSIENT), index);
+	}
+	statement& bind_blob(int index, const void* data, std::size_t size)
+	{
+		return bound(sqlite3_bind_blob64(m_stmt, index, data, size, SQLITE_TRANSIENT), index);
+	}
+#ifdef KONATA_SQLITE3_HAS_STRING_VIEW
+	statement& bind(int index, std::string_view value)
+	{
+		return bound(sqlite3_bind_text64(m_stmt, index, value.data(), value.size(), SQLITE_TRANSIENT, SQLITE_UTF8), index);
+	}
+#endif
+
+	// The bind_static family binds with SQLITE_STATIC: the caller's buffer is
+	// not copied and must stay unchanged until the statement is reset, rebound
+	// or finalized.
+	statement& bind_static(int index, const std::string& value)
+	{
+		return bind_static_text(index, value.data(), value.size());
+	}
+#ifdef KONATA_SQLITE3_HAS_STRING_VIEW
+	statement& bind_static(int index, std::string_view value)
+	{
+		return bind_static_text(index, value.data(), value.size());
+	}
+#endif
+	statement& bind_static_text(int index, const char* data, std::size_t size)
+	{
+		bound(sqlite3_bind_text64(m_stmt, index, data, size, SQLITE_STATIC, SQLITE_UTF8), index);
+		track_static_binding(index, data, size);
+		return *this;
+	}
+	statement& bind_static_blob(int index, const void* data, std::size_t size)
+	{
+		bound(sqlite3_bind_blob64(m_stmt, index, data, size, SQLITE_STATIC), index);
+		track_static_binding(index, data, size);
+		return *this;
+	}
+
+	int bind_parameter_count() const noexcept { return sqlite3_bind_parameter_count(m_stmt); }
+	int column_count() const noexcept { return sqlite3_column_count(m_stmt); }
+	int column_type(int column) const noexcept { return sqlite3_column_type(m_stmt, column); }
+	const char* column_name(int column) const noexcept { return sqlite3_column_name(m_stmt, column); }
+
+	int column_int(int column) const noexcept { return sqlite3_column_int(m_stmt, column); }
+	std::int64_t column_int64(int column) const noexcept { return sqlite3_column_int64(m_stmt, column); }
+	double column_double(int column) const noexcept { return sqlite3_column_double(m_stmt, column); }
+
+	std::string column_string(int column) const
+	{
+		auto p = reinterpret_cast<const char*>(sqlite3_column_text(m_stmt, column));
+		auto size = sqlite3_column_bytes(m_stmt, column);
+		return p != nullptr ? std::string(p, static_cast<std::size_t>(size)) : std::string();
+	}
+
+	// Views into SQLite's own buffer, valid until the next step(), reset() or
+	// conversion of the same column.
+#ifdef KONATA_SQLITE3_HAS_STRING_VIEW
+	std::string_view column_text_view(int column) const noexcept
+	{
+		auto p = reinterpret_cast<const char*>(sqlite3_column_text(m_stmt, column));
+		auto size = sqlite3_column_bytes(m_stmt, column);
+		return p != nullptr ? std::string_view(p, static_cast<std::size_t>(size)) : std::string_view();
+	}
+#endif
+
+	blob_view column_blob(int column) const noexcept
+	{
+		auto p = static_cast<const unsigned char*>(sqlite3_column_blob(m_stmt, column));
+		auto size = sqlite3_column_bytes(m_stmt, column);
+		blob_view ret = { p, p != nullptr ? static_cast<std::size_t>(size) : 0 };
+		return ret;
+	}
+
+	const char* sql() const noexcept { return sqlite3_sql(m_stmt); }
+	::sqlite3* db_handle() const noexcept { return sqlite3_db_handle(m_stmt); }
+
+	void reset_handle(sqlite3_stmt* stmt = nullptr) noexcept
+	{
+		if (m_stmt != nullptr)
+			sqlite3_finalize(m_stmt);
+		m_stmt = stmt;
+		m_staticBindings.clear();
+	}
+
+	sqlite3_stmt* release() noexcept
+	{
+		sqlite3_stmt* ret = m_stmt;
+		m_stmt = nullptr;
+		m_staticBindings.clear();
+		return ret;
+	}
+
+	void swap(statement& y) noexcept
+	{
+		std::swap(m_stmt, y.m_stmt);
+		m_staticBindings.swap(y.m_staticBindings);
+	}
+
+	explicit operator bool() const noexcept { return m_stmt != nullptr; }
+	sqlite3_stmt* get() const noexcept { return m_stmt; }
+
+private:
+	statement& bound(int rc, int index)
+	{
+		throw_if_error(rc, db_handle());
+		for (auto it = m_staticBindings.begin(); it != m_staticBindings.end(); ++it)
+		{
+			if (it->index == index)
+			{
+				m_staticBindings.erase(it);
+				break;
+			}
+		}
+		return *this;
+	}
+
+	sqlite3_stmt* m_stmt;
+
+	struct static_binding
+	{
+		int index;
+		const void* data;
+		std::size_t size;
+		std::uint64_t hash;
+	};
+
+	static std::uint64_t hash_bytes(const void* data, std::size_t size) noexcept
+	{
+		// FNV-1a
+		auto p = static_cast<const unsigned char*>(data);
+		std::uint64_t h = 14695981039346656037u;
+		for (std::size_t i = 0; i < size; ++i)
+			h = (h ^ p[i]) * 1099511628211u;
+		return h;
+	}
+
+	// Recorded only when checking, so that other builds do not pay for
+	// hashing; step() checks whatever was recorded.
+	void track_static_binding(int index, const void* data, std::size_t size)
+	{
+#ifdef KONATA_SQLITE3_CHECK_STATIC_BINDINGS
+		static_binding b = { index, data, size, hash_bytes(data, size) };
+		m_staticBindings.push_back(b);
+#else
+		(void)index;
+		(void)data;
+		(void)size;
+#endif
+	}
+
+	void check_static_bindings() const noexcept
+	{
+		for (const auto& b : m_staticBindings)
+		{
+			(void)b;
+			assert(hash_bytes(b.data, b.size) == b.hash && "buffer bound with SQLITE_STATIC was modified or freed");
+		}
+	}
+
+	std::vector<static_binding> m_staticBindings;
+};
+
+} // namespace sqlite3
+} // namespace konata
+
+#endif // KONATA_SQLITE3_CONNECTION_HPP
@@ -0,0 +1,260 @@
+/*
+sqlite3/connection_pool.hpp: Copyright (c) Egtra 2026
+
+Distributed under the Boost Software License, Version 1.0.
+(See accompanying file LICENSE.txt or copy at
+http://www.boost.org/LICENSE_1_0.txt )
+*/
+
+#ifndef KONATA_SQLITE3_CONNECTION_POOL_HPP
+#define KONATA_SQLITE3_CONNECTION_POOL_HPP
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <konata/sqlite3/connection.hpp>
+#include <konata/sqlite3/statement_cache.hpp>
+
+namespace konata
+{
+namespace sqlite3
+{
+
+struct connection_pool_options
+{
+	// 0 means std::thread::hardware_concurrency().
+	std::size_t reader_count = 0;
+	int busy_timeout_ms = 5000;
+	std::size_t statement_cache_capacity = 16;
+};
+
+// One database file in WAL mode shared by N read-only connections and a
+// single writer connection. Readers are checked out per thread; the writer
+// is owned by a dedicated thread that runs queued write requests in order.
+class connection_pool
+{
+	struct reader_slot
+	{
+		reader_slot(connection&& c, std::size_t cacheCapacity)
+			: conn(std::move(c)), statements(conn.get(), cacheCapacity), in_use(false) {}
+
+		connection conn;
+		statement_cache statements;
+		std::atomic<bool> in_use;
+	};
+
+public:
+	class reader_lease
+	{
+	public:
+		reader_lease() noexcept : m_pool(), m_slot() {}
+		reader_lease(reader_lease&& y) noexcept : m_pool(y.m_pool), m_slot(y.m_slot)
+		{
+			y.m_pool = nullptr;
+			y.m_slot = nullptr;
+		}
+		reader_lease& operator=(reader_lease&& y) noexcept
+		{
+			if (this != &y)
+			{
+				release();
+				m_pool = y.m_pool;
+				m_slot = y.m_slot;
+				y.m_pool = nullptr;
+				y.m_slot = nullptr;
+			}
+			return *this;
+		}
+		reader_lease(const reader_lease&) = delete;
+		reader_lease& operator=(const reader_lease&) = delete;
+		~reader_lease() { release(); }
+
+		void release() noexcept
+		{
+			if (m_slot != nullptr)
+				m_pool->check_in(*m_slot);
+			m_pool = nullptr;
+			m_slot = nullptr;
+		}
+
+		connection& operator*() const noexcept { return m_slot->conn; }
+		connection* operator->() const noexcept { return &m_slot->conn; }
+		::sqlite3* get() const noexcept { return m_slot->conn.get(); }
+		statement_cache& statements() const noexcept { return m_slot->statements; }
+		explicit operator bool() const noexcept { return m_slot != nullptr; }
+
+	private:
+		friend class connection_pool;
+		reader_lease(connection_pool* pool, reader_slot* slot) noexcept : m_pool(pool), m_slot(slot) {}
+
+		connection_pool* m_pool;
+		reader_slot* m_slot;
+	};
+
+	explicit connection_pool(const std::string& filename, const connection_pool_options& options = connection_pool_options())
+		: m_waiters(0), m_stopping(false)
+	{
+		connection writer(filename.c_str(), SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX);
+		throw_if_error(sqlite3_busy_timeout(writer.get(), options.busy_timeout_ms), writer.get());
+		writer.exec("PRAGMA journal_mode=WAL");
+
+		std::size_t n = options.reader_count;
+		if (n == 0)
+			n = std::thread::hardware_concurrency();
+		if (n == 0)
+			n = 1;
+		m_readers.reserve(n);
+		for (std::size_t i = 0; i < n; ++i)
+		{
+			connection reader(filename.c_str(), SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX);
+			throw_if_error(sqlite3_busy_timeout(reader.get(), options.busy_timeout_ms), reader.get());
+			m_readers.emplace_back(new reader_slot(std::move(reader), options.statement_cache_capacity));
+		}
+
+		m_writer = std::move(writer);
+		m_writerThread = std::thread([this] { writer_loop(); });
+	}
+
+	connection_pool(const connection_pool&) = delete;
+	connection_pool& operator=(const connection_pool&) = delete;
+
+	// Pending write requests are completed before the writer thread exits.
+	// All reader_leases must have been released.
+	~connection_pool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_queueMutex);
+			m_stopping = true;
+		}
+		m_queueCondition.notify_one();
+		m_writerThread.join();
+	}
+
+	// Blocks only when every reader connection is checked out.
+	reader_lease acquire_reader()
+	{
+		std::size_t n = m_readers.size();
+		std::size_t& hint = preferred_slot();
+		for (std::size_t i = 0; i < n; ++i)
+		{
+			std::size_t index = (hint + i) % n;
+			if (try_check_out(*m_readers[index]))
+			{
+				hint = index;
+				return reader_lease(this, m_readers[index].get());
+			}
+		}
+
+		std::unique_lock<std::mutex> lock(m_readerMutex);
+		++m_waiters;
+		for (;;)
+		{
+			for (std::size_t i = 0; i < n; ++i)
+			{
+				if (try_check_out_waiting(*m_readers[i]))
+				{
+					--m_waiters;
+					hint = i;
+					return reader_lease(this, m_readers[i].get());
+				}
+			}
+			m_readerCondition.wait(lock);
+		}
+	}
+
+	// Runs f(connection&) on the writer thread. Requests are executed one at a
+	// time in submission order; the result or exception is delivered through
+	// the returned future.
+	template<typename F>
+	auto write(F&& f) -> std::future<decltype(f(std::declval<connection&>()))>
+	{
+		typedef decltype(f(std::declval<connection&>())) result_type;
+		auto task = std::make_shared<std::packaged_task<result_type(connection&)>>(std::forward<F>(f));
+		auto result = task->get_future();
+		{
+			std::lock_guard<std::mutex> lock(m_queueMutex);
+			m_queue.emplace_back([task](connection& c) { (*task)(c); });
+		}
+		m_queueCondition.notify_one();
+		return result;
+	}
+
+	std::size_t reader_count() const noexcept { return m_readers.size(); }
+
+private:
+	static std::size_t& preferred_slot() noexcept
+	{
+		thread_local std::size_t hint = std::hash<std::thread::id>()(std::this_thread::get_id());
+		return hint;
+	}
+
+	static bool try_check_out(reader_slot& slot) noexcept
+	{
+		return !slot.in_use.load(std::memory_order_relaxed) && !slot.in_use.exchange(true);
+	}
+
+	// With m_waiters raised: check_in stores in_use then loads m_waiters,
+	// and this loads in_use after the increment. Both sides must be
+	// sequentially consistent, or each may miss the other's store and the
+	// waiter sleeps with nobody to wake it.
+	static bool try_check_out_waiting(reader_slot& slot) noexcept
+	{
+		return !slot.in_use.load(std::memory_order_seq_cst) && !slot.in_use.exchange(true);
+	}
+
+	void check_in(reader_slot& slot) noexcept
+	{
+		slot.in_use.store(false);
+		if (m_waiters.load() != 0)
+		{
+			std::lock_guard<std::mutex> lock(m_readerMutex);
+			m_readerCondition.notify_one();
+		}
+	}
+
+	void writer_loop()
+	{
+		std::unique_lock<std::mutex> lock(m_queueMutex);
+		for (;;)
+		{
+			m_queueCondition.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+			if (m_queue.empty())
+				return;
+			auto request = std::move(m_queue.front());
+			m_queue.pop_front();
+			lock.unlock();
+			request(m_writer);
+			lock.lock();
+		}
+	}
+
+	std::vector<std::unique_ptr<reader_slot>> m_readers;
+	std::atomic<std::size_t> m_waiters;
+	std::mutex m_readerMutex;
+	std::condition_variable m_readerCondition;
+
+	connection m_writer;
+	std::deque<std::function<void(connection&)>> m_queue;
+	bool m_stopping;
+	std::mutex m_queueMutex;
+	std::condition_variable m_queueCondition;
+	std::thread m_writerThread;
+};
+
+} // namespace sqlite3
+} // namespace konata
+
+#endif // KONATA_SQLITE3_CONNECTION_POOL_HPP
@@ -46,6 +46,7 @@ inline const std::error_category& sqlite3_error_category()
 				case SQLITE_PERM: return std::error_condition(std::errc::permission_denied); // EACCES
 				case SQLITE_ABORT: return std::error_condition(std::errc::operation_canceled); //ECANCELED
 				case SQLITE_BUSY: return std::error_condition(std::errc::device_or_resource_busy); // EBUSY
+				case SQLITE_LOCKED: return std::error_condition(std::errc::device_or_resource_busy); // EBUSY
 				case SQLITE_NOMEM: return std::error_condition(std::errc::not_enough_memory); // ENOMEM
 				case SQLITE_READONLY: return std::error_condition(std::errc::permission_denied); // EACCES
 				case SQLITE_INTERRUPT: return std::error_condition(std::errc::operation_canceled); //ECANCELED
@@ -54,7 +55,7 @@ inline const std::error_category& sqlite3_error_category()
 				case SQLITE_TOOBIG: return std::error_condition(std::errc::invalid_argument); // EINVAL
 				case SQLITE_AUTH: return std::error_condition(std::errc::permission_denied); // EACCES
 				case SQLITE_RANGE: return std::error_condition(std::errc::invalid_argument); // EINVAL
-				default: return std::error_condition(ev, sqlite3_error_category());
+				default: return std::error_condition(ev, *this);
 			}
 		}
 	};
@@ -0,0 +1,348 @@
+/*
+sqlite3/group_commit.hpp: Copyright (c) Egtra 2026
+
+Distributed under the Boost Software License, Version 1.0.
+(See accompanying file LICENSE.txt or copy at
+http://www.boost.org/LICENSE_1_0.txt )
+*/
+
+#ifndef KONATA_SQLITE3_GROUP_COMMIT_HPP
+#define KONATA_SQLITE3_GROUP_COMMIT_HPP
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <new>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include <konata/sqlite3/connection.hpp>
+
+namespace konata
+{
+namespace sqlite3
+{
+
+struct group_commit_options
+{
+	// Upper bound on the requests committed by one transaction.
+	std::size_t max_batch = 1024;
+	// How long the writer waits for more requests after the first one of a
+	// batch arrives. 0 commits whatever has queued up so far; requests
+	// submitted during a commit still form the next batch.
+	std::chrono::microseconds max_delay = std::chrono::microseconds(0);
+	int busy_timeout_ms = 5000;
+};
+
+struct group_commit_statistics
+{
+	std::uint64_t transactions;
+	std::uint64_t requests;
+	std::uint64_t largest_batch;
+};
+
+namespace detail
+{
+
+inline std::error_code run_write(const std::function<std::error_code(connection&)>& f, connection& c) noexcept
+{
+	try
+	{
+		return f(c);
+	}
+	catch (const std::system_error& e)
+	{
+		return e.code();
+	}
+	catch (const std::bad_alloc&)
+	{
+		return make_error_code_from_result(SQLITE_NOMEM);
+	}
+	catch (...)
+	{
+		return make_error_code_from_result(SQLITE_ERROR);
+	}
+}
+
+template<typename F>
+std::function<std::error_code(connection&)> make_write(F&& f, std::true_type /* returns void */)
+{
+	typedef typename std::decay<F>::type function_type;
+	function_type g(std::forward<F>(f));
+	return [g](connection& c) mutable { g(c); return std::error_code(); };
+}
+
+template<typename F>
+std::function<std::error_code(connection&)> make_write(F&& f, std::false_type)
+{
+	return std::forward<F>(f);
+}
+
+} // namespace detail
+
+// Batches writes from many threads into shared transactions so that they
+// share one commit (and one fsync). A producer submits f(connection&),
+// returning void or std::error_code, and gets a future of its own
+// std::error_code; exceptions thrown by f are turned into codes as well.
+// Each request runs inside its own SAVEPOINT, so a failing request is
+// rolled back without affecting the rest of its batch; if the commit
+// itself fails, every request of the batch reports that error. Errors
+// such as SQLITE_FULL, SQLITE_IOERR or an interrupt make SQLite roll back
+// the whole transaction instead; the requests it had run then report the
+// error too, and the rest of the batch goes on in a new transaction.
+// Submission is a lock-free push; only a producer that finds the queue
+// empty (or fills a batch) takes the mutex to wake the writer.
+class group_commit_writer
+{
+public:
+	explicit group_commit_writer(connection&& writer, const group_commit_options& options = group_commit_options())
+		: m_writer(std::move(writer)), m_options(options), m_head(nullptr), m_pending(0), m_stopping(false),
+		m_transactions(0), m_requests(0), m_largestBatch(0)
+	{
+		if (m_options.max_batch == 0)
+			m_options.max_batch = 1;
+		throw_if_error(sqlite3_busy_timeout(m_writer.get(), m_options.busy_timeout_ms), m_writer.get());
+		m_begin.prepare(m_writer.get(), "BEGIN IMMEDIATE");
+		m_commit.prepare(m_writer.get(), "COMMIT");
+		m_rollback.prepare(m_writer.get(), "ROLLBACK");
+		m_savepoint.prepare(m_writer.get(), "SAVEPOINT konata_group_commit");
+		m_release.prepare(m_writer.get(), "RELEASE konata_group_commit");
+		m_rollbackTo.prepare(m_writer.get(), "ROLLBACK TO konata_group_commit");
+		m_thread = std::thread([this] { writer_loop(); });
+	}
+
+	explicit group_commit_writer(const char* filename, const group_commit_options& options = group_commit_options())
+		: group_commit_writer(connection(filename, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX), options)
+	{
+	}
+
+	group_commit_writer(const group_commit_writer&) = delete;
+	group_commit_writer& operator=(const group_commit_writer&) = delete;
+
+	// Requests already submitted are committed before the thread exits.
+	~group_commit_writer()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stopping = true;
+		}
+		m_condition.notify_one();
+		m_thread.join();
+	}
+
+	template<typename F>
+	std::future<std::error_code> submit(F&& f)
+	{
+		typedef std::is_void<decltype(f(std::declval<connection&>()))> returns_void;
+		auto r = new request(detail::make_write(std::forward<F>(f), returns_void()));
+		auto result = r->done.get_future();
+		push(r);
+		return result;
+	}
+
+	group_commit_statistics statistics() const noexcept
+	{
+		group_commit_statistics s;
+		s.transactions = m_transactions.load(std::memory_order_relaxed);
+		s.requests = m_requests.load(std::memory_order_relaxed);
+		s.largest_batch = m_largestBatch.load(std::memory_order_relaxed);
+		return s;
+	}
+
+private:
+	struct request
+	{
+		explicit request(std::function<std::error_code(connection&)>&& f) : next(nullptr), work(std::move(f)) {}
+
+		request* next;
+		std::function<std::error_code(connection&)> work;
+		std::promise<std::error_code> done;
+		std::error_code result;
+	};
+
+	void push(request* r)
+	{
+		request* head = m_head.load(std::memory_order_relaxed);
+		do
+		{
+			r->next = head;
+		} while (!m_head.compare_exchange_weak(head, r, std::memory_order_release, std::memory_order_relaxed));
+		auto pending = m_pending.fetch_add(1, std::memory_order_relaxed) + 1;
+		if (head == nullptr || pending == m_options.max_batch)
+		{
+			// Taking the mutex orders this push with the writer's predicate check.
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+			}
+			m_condition.notify_one();
+		}
+	}
+
+	// Takes every queued request, oldest first.
+	request* take_all() noexcept
+	{
+		request* r = m_head.exchange(nullptr, std::memory_order_acquire);
+		request* reversed = nullptr;
+		std::size_t n = 0;
+		while (r != nullptr)
+		{
+			request* next = r->next;
+			r->next = reversed;
+			reversed = r;
+			r = next;
+			++n;
+		}
+		m_pending.fetch_sub(n, std::memory_order_relaxed);
+		return reversed;
+	}
+
+	void writer_loop()
+	{
+		request* queue = nullptr;
+		request* tail = nullptr;
+		for (;;)
+		{
+			if (queue == nullptr)
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_condition.wait(lock, [this] { return m_stopping || m_head.load(std::memory_order_relaxed) != nullptr; });
+				if (m_head.load(std::memory_order_relaxed) == nullptr)
+					return;
+				if (m_options.max_delay.count() > 0 && !m_stopping)
+				{
+					m_condition.wait_for(lock, m_options.max_delay,
+						[this] { return m_stopping || m_pending.load(std::memory_order_relaxed) >= m_options.max_batch; });
+				}
+			}
+			request* taken = take_all();
+			if (queue == nullptr)
+				queue = taken;
+			else
+				tail->next = taken;
+			if (queue == nullptr)
+				continue;
+
+			// Split off at most max_batch requests.
+			request* batch = queue;
+			request* last = batch;
+			std::size_t n = 1;
+			while (last->next != nullptr && n < m_options.max_batch)
+			{
+				last = last->next;
+				++n;
+			}
+			queue = last->next;
+			last->next = nullptr;
+			tail = queue;
+			while (tail != nullptr && tail->next != nullptr)
+				tail = tail->next;
+
+			run_batch(batch, n);
+		}
+	}
+
+	int step(statement& s) noexcept
+	{
+		int rc = s.raw_step();
+		s.reset();
+		return rc == SQLITE_DONE || rc == SQLITE_ROW ? SQLITE_OK : rc;
+	}
+
+	void run_batch(request* batch, std::size_t n) noexcept
+	{
+		std::error_code batchError = make_error_code_from_result(step(m_begin));
+		std::uint64_t transactions = 1;
+		request* first = batch; // the first request of the open transaction
+		for (request* r = batch; r != nullptr && !batchError; r = r->next)
+		{
+			int rc = step(m_savepoint);
+			if (rc != SQLITE_OK)
+			{
+				r->result = make_error_code_from_result(rc);
+			}
+			else
+			{
+				r->result = detail::run_write(r->work, m_writer);
+				if (r->result)
+					step(m_rollbackTo);
+				step(m_release);
+			}
+			if (sqlite3_get_autocommit(m_writer.get()))
+			{
+				// SQLite rolled back the whole transaction (and with it the
+				// savepoints), so the requests run in it lost their writes.
+				std::error_code lost = r->result ? r->result : make_error_code_from_result(SQLITE_ABORT);
+				for (request* q = first; q != r->next; q = q->next)
+				{
+					if (!q->result)
+						q->result = lost;
+				}
+				first = r->next;
+				if (first != nullptr)
+				{
+					batchError = make_error_code_from_result(step(m_begin));
+					++transactions;
+				}
+			}
+		}
+		if (!batchError && first != nullptr)
+		{
+			int rc = step(m_commit);
+			if (rc != SQLITE_OK)
+			{
+				batchError = make_error_code_from_result(rc);
+				if (!sqlite3_get_autocommit(m_writer.get()))
+					step(m_rollback);
+			}
+		}
+
+		m_transactions.fetch_add(transactions, std::memory_order_relaxed);
+		m_requests.fetch_add(n, std::memory_order_relaxed);
+		auto largest = m_largestBatch.load(std::memory_order_relaxed);
+		while (largest < n && !m_largestBatch.compare_exchange_weak(largest, n, std::memory_order_relaxed))
+		{
+		}
+
+		while (batch != nullptr)
+		{
+			request* next = batch->next;
+			batch->done.set_value(batch->result ? batch->result : batchError);
+			delete batch;
+			batch = next;
+		}
+	}
+
+	connection m_writer;
+	group_commit_options m_options;
+	statement m_begin;
+	statement m_commit;
+	statement m_rollback;
+	statement m_savepoint;
+	statement m_release;
+	statement m_rollbackTo;
+
+	std::atomic<request*> m_head; // newest first
+	std::atomic<std::size_t> m_pending;
+	bool m_stopping;
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+	std::thread m_thread;
+
+	std::atomic<std::uint64_t> m_transactions;
+	std::atomic<std::uint64_t> m_requests;
+	std::atomic<std::uint64_t> m_largestBatch;
+};
+
+} // namespace sqlite3
+} // namespace konata
+
+#endif // KONATA_SQLITE3_GROUP_COMMIT_HPP
@@ -0,0 +1,403 @@
+/*
+sqlite3/memory_vfs.hpp: Copyright (c) Egtra 2026
+
+Distributed under the Boost Software License, Version 1.0.
+(See accompanying file LICENSE.txt or copy at
+http://www.boost.org/LICENSE_1_0.txt )
+*/
+
+#ifndef KONATA_SQLITE3_MEMORY_VFS_HPP
+#define KONATA_SQLITE3_MEMORY_VFS_HPP
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <konata/sqlite3/connection.hpp>
+
+namespace konata
+{
+namespace sqlite3
+{
+
+// A VFS keeping each file as a named in-memory image. Every connection
+// that opens the same name with this VFS shares the same image, e.g.
+//   connection c("cache.db", SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, vfs.name());
+// An image lives until it is deleted (remove() or xDelete, as SQLite does
+// for rollback journals) or the memory_vfs is destroyed.
+// Locking follows the usual SQLite lock levels between connections.
+// The VFS has no shared-memory methods, so WAL mode is not available.
+class memory_vfs
+{
+public:
+	static const char* default_name() noexcept { return "konata-memdb"; }
+
+	explicit memory_vfs(const char* name = default_name(), bool makeDefault = false)
+		: m_name(name), m_base(sqlite3_vfs_find(nullptr))
+	{
+		if (m_base == nullptr)
+			throw std::system_error(SQLITE_ERROR, sqlite3_error_category(), "no default VFS");
+		m_vfs = sqlite3_vfs();
+		m_vfs.iVersion = 2;
+		m_vfs.szOsFile = static_cast<int>(sizeof(memory_file));
+		m_vfs.mxPathname = 512;
+		m_vfs.zName = m_name.c_str();
+		m_vfs.pAppData = this;
+		m_vfs.xOpen = &x_open;
+		m_vfs.xDelete = &x_delete;
+		m_vfs.xAccess = &x_access;
+		m_vfs.xFullPathname = &x_full_pathname;
+		m_vfs.xDlOpen = [](sqlite3_vfs* v, const char* name) { return base_of(v)->xDlOpen(base_of(v), name); };
+		m_vfs.xDlError = [](sqlite3_vfs* v, int n, char* out) { base_of(v)->xDlError(base_of(v), n, out); };
+		m_vfs.xDlSym = [](sqlite3_vfs* v, void* h, const char* sym) { return base_of(v)->xDlSym(base_of(v), h, sym); };
+		m_vfs.xDlClose = [](sqlite3_vfs* v, void* h) { base_of(v)->xDlClose(base_of(v), h); };
+		m_vfs.xRandomness = [](sqlite3_vfs* v, int n, char* out) { return base_of(v)->xRandomness(base_of(v), n, out); };
+		m_vfs.xSleep = [](sqlite3_vfs* v, int us) { return base_of(v)->xSleep(base_of(v), us); };
+		m_vfs.xCurrentTime = [](sqlite3_vfs* v, double* t) { return base_of(v)->xCurrentTime(base_of(v), t); };
+		m_vfs.xGetLastError = [](sqlite3_vfs*, int, char*) { return 0; };
+		m_vfs.xCurrentTimeInt64 = [](sqlite3_vfs* v, sqlite3_int64* t)
+		{
+			if (base_of(v)->iVersion >= 2 && base_of(v)->xCurrentTimeInt64 != nullptr)
+				return base_of(v)->xCurrentTimeInt64(base_of(v), t);
+			double d;
+			int rc = base_of(v)->xCurrentTime(base_of(v), &d);
+			*t = static_cast<sqlite3_int64>(d * 86400000.0);
+			return rc;
+		};
+		throw_if_error(sqlite3_vfs_register(&m_vfs, makeDefault ? 1 : 0));
+	}
+
+	memory_vfs(const memory_vfs&) = delete;
+	memory_vfs& operator=(const memory_vfs&) = delete;
+
+	// Every connection using this VFS must have been closed.
+	~memory_vfs()
+	{
+		sqlite3_vfs_unregister(&m_vfs);
+	}
+
+	const char* name() const noexcept { return m_name.c_str(); }
+	sqlite3_vfs* get() noexcept { return &m_vfs; }
+
+	bool exists(const std::string& filename) const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_images.find(filename) != m_images.end();
+	}
+
+	// Drops the image; connections that have it open keep their copy alive.
+	bool remove(const std::string& filename)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_images.erase(filename) != 0;
+	}
+
+	// Copies the current contents of an image (e.g. to persist a cache).
+	std::vector<unsigned char> contents(const std::string& filename) const
+	{
+		std::shared_ptr<image> img;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			auto it = m_images.find(filename);
+			if (it == m_images.end())
+				throw std::system_error(SQLITE_CANTOPEN, sqlite3_error_category(), filename);
+			img = it->second;
+		}
+		std::lock_guard<std::mutex> lock(img->mutex);
+		return img->data;
+	}
+
+	// Creates or replaces an image with the given database contents.
+	// Must not be called while a connection has the image open.
+	void load(const std::string& filename, std::vector<unsigned char> data)
+	{
+		auto img = std::make_shared<image>();
+		img->data = std::move(data);
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_images[filename] = std::move(img);
+	}
+
+private:
+	struct image
+	{
+		std::mutex mutex;
+		std::vector<unsigned char> data;
+		int sharedCount = 0;
+		const void* reserved = nullptr; // owner of RESERVED (or PENDING/EXCLUSIVE)
+		const void* pending = nullptr;
+		const void* exclusive = nullptr;
+	};
+
+	struct memory_file
+	{
+		sqlite3_file base;
+		std::shared_ptr<image>* img;
+		int lockLevel;
+	};
+
+	static sqlite3_vfs* base_of(sqlite3_vfs* v) noexcept
+	{
+		return static_cast<memory_vfs*>(v->pAppData)->m_base;
+	}
+
+	static memory_file* file_of(sqlite3_file* f) noexcept
+	{
+		return reinterpret_cast<memory_file*>(f);
+	}
+
+	static image& image_of(sqlite3_file* f) noexcept
+	{
+		return **file_of(f)->img;
+	}
+
+	static int x_open(sqlite3_vfs* v, const char* name, sqlite3_file* file, int flags, int* outFlags)
+	{
+		auto self = static_cast<memory_vfs*>(v->pAppData);
+		auto f = file_of(file);
+		f->base.pMethods = nullptr;
+		f->lockLevel = SQLITE_LOCK_NONE;
+		try
+		{
+			std::shared_ptr<image> img;
+			if (name == nullptr)
+			{
+				img = std::make_shared<image>();
+			}
+			else
+			{
+				std::lock_guard<std::mutex> lock(self->m_mutex);
+				auto it = self->m_images.find(name);
+				if (it != self->m_images.end())
+				{
+					if ((flags & SQLITE_OPEN_EXCLUSIVE) != 0)
+						return SQLITE_CANTOPEN;
+					img = it->second;
+				}
+				else
+				{
+					if ((flags & SQLITE_OPEN_CREATE) == 0)
+						return SQLITE_CANTOPEN;
+					img = std::make_shared<image>();
+					if ((flags & SQLITE_OPEN_DELETEONCLOSE) == 0)
+						self->m_images.emplace(name, img);
+				}
+			}
+			f->img = new std::shared_ptr<image>(std::move(img));
+		}
+		catch (const std::bad_alloc&)
+		{
+			return SQLITE_NOMEM;
+		}
+		if (outFlags != nullptr)
+			*outFlags = flags;
+		f->base.pMethods = &methods();
+		return SQLITE_OK;
+	}
+
+	static int x_delete(sqlite3_vfs* v, const char* name, int)
+	{
+		auto self = static_cast<memory_vfs*>(v->pAppData);
+		std::lock_guard<std::mutex> lock(self->m_mutex);
+		self->m_images.erase(name);
+		return SQLITE_OK;
+	}
+
+	static int x_access(sqlite3_vfs* v, const char* name, int, int* out)
+	{
+		auto self = static_cast<memory_vfs*>(v->pAppData);
+		std::lock_guard<std::mutex> lock(self->m_mutex);
+		auto it = self->m_images.find(name);
+		// SQLite only probes journals for existence; an empty journal is
+		// treated like a missing one.
+		*out = 0;
+		if (it != self->m_images.end())
+		{
+			std::lock_guard<std::mutex> imageLock(it->second->mutex);
+			*out = !it->second->data.empty();
+		}
+		return SQLITE_OK;
+	}
+
+	static int x_full_pathname(sqlite3_vfs*, const char* name, int n, char* out)
+	{
+		auto length = std::strlen(name);
+		if (length + 1 > static_cast<std::size_t>(n))
+			return SQLITE_CANTOPEN;
+		std::memcpy(out, name, length + 1);
+		return SQLITE_OK;
+	}
+
+	static int x_close(sqlite3_file* file)
+	{
+		auto f = file_of(file);
+		x_unlock(file, SQLITE_LOCK_NONE);
+		delete f->img;
+		f->img = nullptr;
+		return SQLITE_OK;
+	}
+
+	static int x_read(sqlite3_file* file, void* buffer, int amount, sqlite3_int64 offset)
+	{
+		auto& img = image_of(file);
+		std::lock_guard<std::mutex> lock(img.mutex);
+		auto size = static_cast<sqlite3_int64>(img.data.size());
+		auto available = offset < size ? std::min<sqlite3_int64>(amount, size - offset) : 0;
+		if (available > 0)
+			std::memcpy(buffer, img.data.data() + offset, static_cast<std::size_t>(available));
+		if (available < amount)
+		{
+			std::memset(static_cast<unsigned char*>(buffer) + available, 0, static_cast<std::size_t>(amount - available));
+			return SQLITE_IOERR_SHORT_READ;
+		}
+		return SQLITE_OK;
+	}
+
+	static int x_write(sqlite3_file* file, const void* buffer, int amount, sqlite3_int64 offset)
+	{
+		auto& img = image_of(file);
+		std::lock_guard<std::mutex> lock(img.mutex);
+		try
+		{
+			auto end = static_cast<std::size_t>(offset + amount);
+			if (img.data.size() < end)
+				img.data.resize(end);
+		}
+		catch (const std::bad_alloc&)
+		{
+			return SQLITE_IOERR_NOMEM;
+		}
+		std::memcpy(img.data.data() + offset, buffer, static_cast<std::size_t>(amount));
+		return SQLITE_OK;
+	}
+
+	static int x_truncate(sqlite3_file* file, sqlite3_int64 size)
+	{
+		auto& img = image_of(file);
+		std::lock_guard<std::mutex> lock(img.mutex);
+		if (static_cast<std::size_t>(size) < img.data.size())
+		{
+			img.data.resize(static_cast<std::size_t>(size));
+			img.data.shrink_to_fit();
+		}
+		return SQLITE_OK;
+	}
+
+	static int x_file_size(sqlite3_file* file, sqlite3_int64* size)
+	{
+		auto& img = image_of(file);
+		std::lock_guard<std::mutex> lock(img.mutex);
+		*size = static_cast<sqlite3_int64>(img.data.size());
+		return SQLITE_OK;
+	}
+
+	static int x_lock(sqlite3_file* file, int level)
+	{
+		auto f = file_of(file);
+		if (f->lockLevel >= level)
+			return SQLITE_OK;
+		auto& img = image_of(file);
+		std::lock_guard<std::mutex> lock(img.mutex);
+		switch (level)
+		{
+		case SQLITE_LOCK_SHARED:
+			if (img.pending != nullptr || img.exclusive != nullptr)
+				return SQLITE_BUSY;
+			++img.sharedCount;
+			break;
+		case SQLITE_LOCK_RESERVED:
+			if (img.reserved != nullptr)
+				return SQLITE_BUSY;
+			img.reserved = f;
+			break;
+		case SQLITE_LOCK_EXCLUSIVE:
+			if (img.pending != nullptr && img.pending != f)
+				return SQLITE_BUSY;
+			// PENDING keeps new readers out while the existing ones finish.
+			img.pending = f;
+			if (img.sharedCount > 1)
+			{
+				f->lockLevel = SQLITE_LOCK_PENDING;
+				return SQLITE_BUSY;
+			}
+			img.exclusive = f;
+			break;
+		default:
+			return SQLITE_OK;
+		}
+		f->lockLevel = level;
+		return SQLITE_OK;
+	}
+
+	static int x_unlock(sqlite3_file* file, int level)
+	{
+		auto f = file_of(file);
+		if (f->lockLevel <= level)
+			return SQLITE_OK;
+		auto& img = image_of(file);
+		std::lock_guard<std::mutex> lock(img.mutex);
+		if (img.exclusive == f)
+			img.exclusive = nullptr;
+		if (img.pending == f)
+			img.pending = nullptr;
+		if (img.reserved == f)
+			img.reserved = nullptr;
+		if (level == SQLITE_LOCK_NONE && f->lockLevel >= SQLITE_LOCK_SHARED)
+			--img.sharedCount;
+		f->lockLevel = level;
+		return SQLITE_OK;
+	}
+
+	static int x_check_reserved_lock(sqlite3_file* file, int* out)
+	{
+		auto& img = image_of(file);
+		std::lock_guard<std::mutex> lock(img.mutex);
+		*out = img.reserved != nullptr || img.pending != nullptr || img.exclusive != nullptr;
+		return SQLITE_OK;
+	}
+
+	static sqlite3_io_methods make_methods() noexcept
+	{
+		sqlite3_io_methods m = {};
+		m.iVersion = 1;
+		m.xClose = &x_close;
+		m.xRead = &x_read;
+		m.xWrite = &x_write;
+		m.xTruncate = &x_truncate;
+		m.xSync = [](sqlite3_file*, int) { return SQLITE_OK; };
+		m.xFileSize = &x_file_size;
+		m.xLock = &x_lock;
+		m.xUnlock = &x_unlock;
+		m.xCheckReservedLock = &x_check_reserved_lock;
+		m.xFileControl = [](sqlite3_file*, int, void*) { return SQLITE_NOTFOUND; };
+		m.xSectorSize = [](sqlite3_file*) { return 4096; };
+		m.xDeviceCharacteristics = [](sqlite3_file*)
+		{
+			return SQLITE_IOCAP_ATOMIC | SQLITE_IOCAP_SAFE_APPEND | SQLITE_IOCAP_SEQUENTIAL | SQLITE_IOCAP_POWERSAFE_OVERWRITE;
+		};
+		return m;
+	}
+
+	static const sqlite3_io_methods& methods() noexcept
+	{
+		static const sqlite3_io_methods m = make_methods();
+		return m;
+	}
+
+	std::string m_name;
+	sqlite3_vfs* m_base;
+	sqlite3_vfs m_vfs;
+	mutable std::mutex m_mutex;
+	std::map<std::string, std::shared_ptr<image>> m_images;
+};
+
+} // namespace sqlite3
+} // namespace konata
+
+#endif // KONATA_SQLITE3_MEMORY_VFS_HPP
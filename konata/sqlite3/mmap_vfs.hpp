@@ -0,0 +1,308 @@
+/*
+sqlite3/mmap_vfs.hpp: Copyright (c) Egtra 2026
+
+Distributed under the Boost Software License, Version 1.0.
+(See accompanying file LICENSE.txt or copy at
+http://www.boost.org/LICENSE_1_0.txt )
+*/
+
+#ifndef KONATA_SQLITE3_MMAP_VFS_HPP
+#define KONATA_SQLITE3_MMAP_VFS_HPP
+
+#pragma once
+
+#include <cstring>
+#include <new>
+#include <string>
+
+#include <sys/mman.h>
+
+#include <konata/sqlite3/connection.hpp>
+
+namespace konata
+{
+namespace sqlite3
+{
+
+enum class mmap_advice
+{
+	normal,
+	random,
+	sequential,
+	willneed,
+};
+
+// A VFS that serves xRead on main database files by copying from a
+// read-only shared mapping of the file, and forwards everything else
+// (writes, locking, WAL shared memory, journals) to the default VFS.
+// The mapping is the default VFS's own (xFetch on the descriptor that
+// holds the locks), kept enabled up to mmapSize bytes whatever PRAGMA
+// mmap_size says, so it follows growth and truncation of the file as
+// SQLite's mmap support does. Files beyond mmapSize, or an SQLite built
+// with SQLITE_MAX_MMAP_SIZE=0, are read with xRead as usual. As with
+// SQLite's own mmap support, truncating the file from another process
+// while it is mapped may raise SIGBUS.
+class mmap_vfs
+{
+public:
+	static const char* default_name() noexcept { return "konata-mmap"; }
+
+	explicit mmap_vfs(const char* name = default_name(), mmap_advice advice = mmap_advice::random, bool makeDefault = false,
+		sqlite3_int64 mmapSize = sqlite3_int64(1) << 30)
+		: m_name(name), m_advice(advice), m_mmapSize(mmapSize), m_base(sqlite3_vfs_find(nullptr))
+	{
+		if (m_base == nullptr)
+			throw std::system_error(SQLITE_ERROR, sqlite3_error_category(), "no default VFS");
+		m_vfs = *m_base;
+		m_vfs.iVersion = m_base->iVersion < 3 ? m_base->iVersion : 3;
+		m_vfs.szOsFile = static_cast<int>(sizeof(mmap_file)) + m_base->szOsFile;
+		m_vfs.pNext = nullptr;
+		m_vfs.zName = m_name.c_str();
+		m_vfs.pAppData = this;
+		m_vfs.xOpen = &x_open;
+		m_vfs.xDelete = [](sqlite3_vfs* v, const char* name, int syncDir) { return base_of(v)->xDelete(base_of(v), name, syncDir); };
+		m_vfs.xAccess = [](sqlite3_vfs* v, const char* name, int flags, int* out) { return base_of(v)->xAccess(base_of(v), name, flags, out); };
+		m_vfs.xFullPathname = [](sqlite3_vfs* v, const char* name, int n, char* out) { return base_of(v)->xFullPathname(base_of(v), name, n, out); };
+		m_vfs.xDlOpen = [](sqlite3_vfs* v, const char* name) { return base_of(v)->xDlOpen(base_of(v), name); };
+		m_vfs.xDlError = [](sqlite3_vfs* v, int n, char* out) { base_of(v)->xDlError(base_of(v), n, out); };
+		m_vfs.xDlSym = [](sqlite3_vfs* v, void* h, const char* sym) { return base_of(v)->xDlSym(base_of(v), h, sym); };
+		m_vfs.xDlClose = [](sqlite3_vfs* v, void* h) { base_of(v)->xDlClose(base_of(v), h); };
+		m_vfs.xRandomness = [](sqlite3_vfs* v, int n, char* out) { return base_of(v)->xRandomness(base_of(v), n, out); };
+		m_vfs.xSleep = [](sqlite3_vfs* v, int us) { return base_of(v)->xSleep(base_of(v), us); };
+		m_vfs.xCurrentTime = [](sqlite3_vfs* v, double* t) { return base_of(v)->xCurrentTime(base_of(v), t); };
+		m_vfs.xGetLastError = [](sqlite3_vfs* v, int n, char* out) { return base_of(v)->xGetLastError(base_of(v), n, out); };
+		if (m_vfs.iVersion >= 2)
+			m_vfs.xCurrentTimeInt64 = [](sqlite3_vfs* v, sqlite3_int64* t) { return base_of(v)->xCurrentTimeInt64(base_of(v), t); };
+		if (m_vfs.iVersion >= 3)
+		{
+			m_vfs.xSetSystemCall = [](sqlite3_vfs* v, const char* name, sqlite3_syscall_ptr p) { return base_of(v)->xSetSystemCall(base_of(v), name, p); };
+			m_vfs.xGetSystemCall = [](sqlite3_vfs* v, const char* name) { return base_of(v)->xGetSystemCall(base_of(v), name); };
+			m_vfs.xNextSystemCall = [](sqlite3_vfs* v, const char* name) { return base_of(v)->xNextSystemCall(base_of(v), name); };
+		}
+		throw_if_error(sqlite3_vfs_register(&m_vfs, makeDefault ? 1 : 0));
+	}
+
+	mmap_vfs(const mmap_vfs&) = delete;
+	mmap_vfs& operator=(const mmap_vfs&) = delete;
+
+	// Every connection using this VFS must have been closed.
+	~mmap_vfs()
+	{
+		sqlite3_vfs_unregister(&m_vfs);
+	}
+
+	const char* name() const noexcept { return m_name.c_str(); }
+	sqlite3_vfs* get() noexcept { return &m_vfs; }
+
+private:
+	struct mmap_file
+	{
+		sqlite3_file base;
+		sqlite3_file* real;
+		mmap_vfs* owner;
+		sqlite3_int64 limit; // mapping limit in effect; 0 unless a main database file
+		int fetched; // pointers handed out to the pager by xFetch
+		const unsigned char* advised; // the mapping madvise was last applied to
+		sqlite3_int64 advisedSize;
+	};
+
+	static sqlite3_vfs* base_of(sqlite3_vfs* v) noexcept
+	{
+		return static_cast<mmap_vfs*>(v->pAppData)->m_base;
+	}
+
+	static mmap_file* file_of(sqlite3_file* f) noexcept
+	{
+		return reinterpret_cast<mmap_file*>(f);
+	}
+
+	static sqlite3_file* real_of(sqlite3_file* f) noexcept
+	{
+		return file_of(f)->real;
+	}
+
+	// Applies the advice to a mapping (or the grown part of one) seen for
+	// the first time; base is the start of the default VFS's mapping, which
+	// covers the file up to the limit.
+	static void advise(mmap_file& f, const unsigned char* base, sqlite3_int64 end) noexcept
+	{
+		if (base == f.advised && end <= f.advisedSize)
+			return;
+		sqlite3_int64 size = 0;
+		if (f.real->pMethods->xFileSize(f.real, &size) != SQLITE_OK)
+			return;
+		if (size > f.limit)
+			size = f.limit;
+		f.advised = base;
+		f.advisedSize = size;
+		int advice = MADV_NORMAL;
+		switch (f.owner->m_advice)
+		{
+			case mmap_advice::normal: advice = MADV_NORMAL; break;
+			case mmap_advice::random: advice = MADV_RANDOM; break;
+			case mmap_advice::sequential: advice = MADV_SEQUENTIAL; break;
+			case mmap_advice::willneed: advice = MADV_WILLNEED; break;
+		}
+		(void)madvise(const_cast<unsigned char*>(base), static_cast<std::size_t>(size), advice);
+	}
+
+	static int x_open(sqlite3_vfs* v, const char* name, sqlite3_file* file, int flags, int* outFlags)
+	{
+		auto self = static_cast<mmap_vfs*>(v->pAppData);
+		auto f = file_of(file);
+		std::memset(f, 0, sizeof(mmap_file));
+		f->real = reinterpret_cast<sqlite3_file*>(f + 1);
+		f->owner = self;
+		int rc = self->m_base->xOpen(self->m_base, name, f->real, flags, outFlags);
+		if (rc != SQLITE_OK)
+		{
+			// pMethods stays null, so SQLite does not call xClose.
+			return rc;
+		}
+		if ((flags & SQLITE_OPEN_MAIN_DB) != 0 && f->real->pMethods->iVersion >= 3 && self->m_mmapSize > 0)
+		{
+			// SQLite clamps the limit to SQLITE_MAX_MMAP_SIZE; read it back.
+			sqlite3_int64 limit = self->m_mmapSize;
+			if (f->real->pMethods->xFileControl(f->real, SQLITE_FCNTL_MMAP_SIZE, &limit) == SQLITE_OK)
+			{
+				limit = -1;
+				if (f->real->pMethods->xFileControl(f->real, SQLITE_FCNTL_MMAP_SIZE, &limit) == SQLITE_OK && limit > 0)
+					f->limit = limit;
+			}
+		}
+		f->base.pMethods = f->real->pMethods->iVersion >= 3 ? &methods_v3() : f->real->pMethods->iVersion == 2 ? &methods_v2() : &methods_v1();
+		return SQLITE_OK;
+	}
+
+	static int x_close(sqlite3_file* file)
+	{
+		auto f = file_of(file);
+		return f->real->pMethods->xClose(f->real);
+	}
+
+	static int x_read(sqlite3_file* file, void* buffer, int amount, sqlite3_int64 offset)
+	{
+		auto f = file_of(file);
+		if (f->limit > 0)
+		{
+			sqlite3_file* real = f->real;
+			void* p = nullptr;
+			int rc = real->pMethods->xFetch(real, offset, amount, &p);
+			if (rc == SQLITE_OK && p == nullptr && f->fetched == 0 && offset + amount <= f->limit)
+			{
+				// The file may have grown past the mapping; map it afresh.
+				real->pMethods->xUnfetch(real, 0, nullptr);
+				f->advised = nullptr;
+				rc = real->pMethods->xFetch(real, offset, amount, &p);
+			}
+			if (rc == SQLITE_OK && p != nullptr)
+			{
+				advise(*f, static_cast<const unsigned char*>(p) - offset, offset + amount);
+				std::memcpy(buffer, p, static_cast<std::size_t>(amount));
+				real->pMethods->xUnfetch(real, offset, p);
+				return SQLITE_OK;
+			}
+		}
+		return f->real->pMethods->xRead(f->real, buffer, amount, offset);
+	}
+
+	static int x_file_control(sqlite3_file* file, int op, void* arg)
+	{
+		auto f = file_of(file);
+		if (op == SQLITE_FCNTL_MMAP_SIZE && f->limit > 0)
+		{
+			// The pager sets its own limit (PRAGMA mmap_size, 0 by default);
+			// keep the mapping at least as large as ours.
+			auto limit = static_cast<sqlite3_int64*>(arg);
+			if (*limit >= 0 && *limit < f->limit)
+				*limit = f->limit;
+		}
+		return f->real->pMethods->xFileControl(f->real, op, arg);
+	}
+
+	static int x_fetch(sqlite3_file* file, sqlite3_int64 offset, int amount, void** pp)
+	{
+		auto f = file_of(file);
+		int rc = f->real->pMethods->xFetch(f->real, offset, amount, pp);
+		if (rc == SQLITE_OK && *pp != nullptr)
+			++f->fetched;
+		return rc;
+	}
+
+	static int x_unfetch(sqlite3_file* file, sqlite3_int64 offset, void* p)
+	{
+		auto f = file_of(file);
+		if (p != nullptr)
+		{
+			--f->fetched;
+		}
+		else
+		{
+			// The pager asks to drop the mapping, e.g. around truncation.
+			if (f->fetched != 0)
+				return SQLITE_OK;
+			f->advised = nullptr;
+		}
+		return f->real->pMethods->xUnfetch(f->real, offset, p);
+	}
+
+	static sqlite3_io_methods make_methods(int version) noexcept
+	{
+		sqlite3_io_methods m = {};
+		m.iVersion = version;
+		m.xClose = &x_close;
+		m.xRead = &x_read;
+		m.xWrite = [](sqlite3_file* f, const void* p, int n, sqlite3_int64 off) { return real_of(f)->pMethods->xWrite(real_of(f), p, n, off); };
+		m.xTruncate = [](sqlite3_file* f, sqlite3_int64 size) { return real_of(f)->pMethods->xTruncate(real_of(f), size); };
+		m.xSync = [](sqlite3_file* f, int flags) { return real_of(f)->pMethods->xSync(real_of(f), flags); };
+		m.xFileSize = [](sqlite3_file* f, sqlite3_int64* size) { return real_of(f)->pMethods->xFileSize(real_of(f), size); };
+		m.xLock = [](sqlite3_file* f, int level) { return real_of(f)->pMethods->xLock(real_of(f), level); };
+		m.xUnlock = [](sqlite3_file* f, int level) { return real_of(f)->pMethods->xUnlock(real_of(f), level); };
+		m.xCheckReservedLock = [](sqlite3_file* f, int* out) { return real_of(f)->pMethods->xCheckReservedLock(real_of(f), out); };
+		m.xFileControl = &x_file_control;
+		m.xSectorSize = [](sqlite3_file* f) { return real_of(f)->pMethods->xSectorSize(real_of(f)); };
+		m.xDeviceCharacteristics = [](sqlite3_file* f) { return real_of(f)->pMethods->xDeviceCharacteristics(real_of(f)); };
+		if (version >= 2)
+		{
+			m.xShmMap = [](sqlite3_file* f, int page, int size, int extend, void volatile** pp) { return real_of(f)->pMethods->xShmMap(real_of(f), page, size, extend, pp); };
+			m.xShmLock = [](sqlite3_file* f, int offset, int n, int flags) { return real_of(f)->pMethods->xShmLock(real_of(f), offset, n, flags); };
+			m.xShmBarrier = [](sqlite3_file* f) { real_of(f)->pMethods->xShmBarrier(real_of(f)); };
+			m.xShmUnmap = [](sqlite3_file* f, int deleteFlag) { return real_of(f)->pMethods->xShmUnmap(real_of(f), deleteFlag); };
+		}
+		if (version >= 3)
+		{
+			m.xFetch = &x_fetch;
+			m.xUnfetch = &x_unfetch;
+		}
+		return m;
+	}
+
+	static const sqlite3_io_methods& methods_v1() noexcept
+	{
+		static const sqlite3_io_methods m = make_methods(1);
+		return m;
+	}
+
+	static const sqlite3_io_methods& methods_v2() noexcept
+	{
+		static const sqlite3_io_methods m = make_methods(2);
+		return m;
+	}
+
+	static const sqlite3_io_methods& methods_v3() noexcept
+	{
+		static const sqlite3_io_methods m = make_methods(3);
+		return m;
+	}
+
+	std::string m_name;
+	mmap_advice m_advice;
+	sqlite3_int64 m_mmapSize;
+	sqlite3_vfs* m_base;
+	sqlite3_vfs m_vfs;
+};
+
+} // namespace sqlite3
+} // namespace konata
+
+#endif // KONATA_SQLITE3_MMAP_VFS_HPP
@@ -0,0 +1,214 @@
+/*
+sqlite3/prefetch_cursor.hpp: Copyright (c) Egtra 2026
+
+Distributed under the Boost Software License, Version 1.0.
+(See accompanying file LICENSE.txt or copy at
+http://www.boost.org/LICENSE_1_0.txt )
+*/
+
+#ifndef KONATA_SQLITE3_PREFETCH_CURSOR_HPP
+#define KONATA_SQLITE3_PREFETCH_CURSOR_HPP
+
+#pragma once
+
+// Requires C++17.
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <konata/sqlite3/query.hpp>
+
+namespace konata
+{
+namespace sqlite3
+{
+
+struct prefetch_options
+{
+	std::size_t batch_size = 256;
+	// Number of batches in the ring buffer, including the one being consumed.
+	std::size_t depth = 4;
+};
+
+// Input range over the rows of a typed_query. A background thread steps
+// the statement and decodes rows into a ring buffer of batches, so at most
+// batch_size * depth rows are held in memory.
+// Row must own its data (e.g. std::string rather than std::string_view).
+// The connection must not be used by other threads while the cursor is
+// active unless it was opened in serialized mode.
+// An error raised by sqlite3_step is thrown as std::system_error from the
+// iterator increment that reaches it.
+template<typename Row>
+class prefetch_cursor
+{
+public:
+	class iterator
+	{
+	public:
+		typedef std::input_iterator_tag iterator_category;
+		typedef Row value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef const Row* pointer;
+		typedef const Row& reference;
+
+		iterator() noexcept : m_cursor() {}
+
+		const Row& operator*() const noexcept { return m_cursor->current(); }
+		const Row* operator->() const noexcept { return &m_cursor->current(); }
+
+		iterator& operator++()
+		{
+			if (!m_cursor->advance())
+				m_cursor = nullptr;
+			return *this;
+		}
+		void operator++(int) { ++*this; }
+
+		friend bool operator==(const iterator& x, const iterator& y) noexcept { return x.m_cursor == y.m_cursor; }
+		friend bool operator!=(const iterator& x, const iterator& y) noexcept { return x.m_cursor != y.m_cursor; }
+
+	private:
+		friend class prefetch_cursor;
+		explicit iterator(prefetch_cursor* c) noexcept : m_cursor(c) {}
+
+		prefetch_cursor* m_cursor;
+	};
+
+	explicit prefetch_cursor(typed_query<Row>&& q, const prefetch_options& options = prefetch_options())
+		: m_query(std::move(q))
+		, m_batches(options.depth < 2 ? 2 : options.depth)
+		, m_batchSize(options.batch_size == 0 ? 1 : options.batch_size)
+		, m_head(0), m_filled(0), m_consuming(false), m_finished(false), m_stopping(false), m_position(0)
+	{
+		for (auto& b : m_batches)
+			b.reserve(m_batchSize);
+		m_producer = std::thread([this] { produce(); });
+	}
+
+	prefetch_cursor(::sqlite3* db, const std::string& sql, const prefetch_options& options = prefetch_options())
+		: prefetch_cursor(typed_query<Row>(db, sql), options)
+	{
+	}
+
+	prefetch_cursor(const prefetch_cursor&) = delete;
+	prefetch_cursor& operator=(const prefetch_cursor&) = delete;
+
+	~prefetch_cursor()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stopping = true;
+		}
+		m_notFull.notify_one();
+		m_producer.join();
+		m_query.reset();
+	}
+
+	iterator begin() { return fetch_batch() ? iterator(this) : iterator(); }
+	iterator end() noexcept { return iterator(); }
+
+private:
+	const Row& current() const noexcept { return m_batches[m_head][m_position]; }
+
+	bool advance()
+	{
+		if (++m_position < m_batches[m_head].size())
+			return true;
+		return fetch_batch();
+	}
+
+	// Releases the batch being consumed and waits for the next one.
+	bool fetch_batch()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		if (m_consuming)
+		{
+			m_batches[m_head].clear();
+			m_head = (m_head + 1) % m_batches.size();
+			--m_filled;
+			m_consuming = false;
+			m_notFull.notify_one();
+		}
+		m_notEmpty.wait(lock, [this] { return m_filled != 0 || m_finished; });
+		if (m_filled == 0)
+		{
+			if (m_error)
+				std::rethrow_exception(std::exchange(m_error, nullptr));
+			return false;
+		}
+		m_consuming = true;
+		m_position = 0;
+		return true;
+	}
+
+	void produce()
+	{
+		std::size_t tail = 0;
+		try
+		{
+			for (;;)
+			{
+				{
+					std::unique_lock<std::mutex> lock(m_mutex);
+					m_notFull.wait(lock, [this] { return m_filled < m_batches.size() || m_stopping; });
+					if (m_stopping)
+						break;
+				}
+				// The consumer never touches a batch outside [head, head + filled).
+				auto& batch = m_batches[tail];
+				bool more = true;
+				while (batch.size() < m_batchSize && (more = m_query.next()))
+					batch.push_back(m_query.row());
+				if (!batch.empty())
+				{
+					std::lock_guard<std::mutex> lock(m_mutex);
+					++m_filled;
+					tail = (tail + 1) % m_batches.size();
+					m_notEmpty.notify_one();
+				}
+				if (!more)
+					break;
+			}
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			// Rows decoded before the error are delivered first.
+			if (!m_batches[tail].empty())
+				++m_filled;
+			m_error = std::current_exception();
+		}
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_finished = true;
+		m_notEmpty.notify_one();
+	}
+
+	typed_query<Row> m_query;
+	std::vector<std::vector<Row>> m_batches;
+	std::size_t m_batchSize;
+
+	std::mutex m_mutex;
+	std::condition_variable m_notEmpty;
+	std::condition_variable m_notFull;
+	std::size_t m_head;
+	std::size_t m_filled;
+	bool m_consuming;
+	bool m_finished;
+	bool m_stopping;
+	std::exception_ptr m_error;
+
+	std::size_t m_position; // consumer only
+	std::thread m_producer;
+};
+
+} // namespace sqlite3
+} // namespace konata
+
+#endif // KONATA_SQLITE3_PREFETCH_CURSOR_HPP
@@ -0,0 +1,328 @@
+/*
+sqlite3/query.hpp: Copyright (c) Egtra 2026
+
+Distributed under the Boost Software License, Version 1.0.
+(See accompanying file LICENSE.txt or copy at
+http://www.boost.org/LICENSE_1_0.txt )
+*/
+
+#ifndef KONATA_SQLITE3_QUERY_HPP
+#define KONATA_SQLITE3_QUERY_HPP
+
+#pragma once
+
+// Requires C++17.
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <konata/sqlite3/connection.hpp>
+
+namespace konata
+{
+namespace sqlite3
+{
+
+// Column affinity derived from the declared type, following the rules of
+// https://www.sqlite.org/datatype3.html#determination_of_column_affinity
+enum class column_affinity
+{
+	integer,
+	text,
+	blob, // also columns without a declared type
+	real,
+	numeric,
+};
+
+inline column_affinity affinity_of_decltype(const char* declared) noexcept
+{
+	if (declared == nullptr)
+		return column_affinity::blob;
+	auto contains = [declared](const char* word) noexcept
+	{
+		for (const char* p = declared; *p != '\0'; ++p)
+		{
+			const char* s = p;
+			const char* w = word;
+			while (*w != '\0' && *s != '\0' && (*s == *w || *s == *w + ('a' - 'A')))
+			{
+				++s;
+				++w;
+			}
+			if (*w == '\0')
+				return true;
+		}
+		return false;
+	};
+	if (contains("INT"))
+		return column_affinity::integer;
+	if (contains("CHAR") || contains("CLOB") || contains("TEXT"))
+		return column_affinity::text;
+	if (contains("BLOB") || *declared == '\0')
+		return column_affinity::blob;
+	if (contains("REAL") || contains("FLOA") || contains("DOUB"))
+		return column_affinity::real;
+	return column_affinity::numeric;
+}
+
+// column_traits<T>::get() reads one cell with a single sqlite3_column_*
+// call; accepts() tells whether a column of the given affinity may be read
+// as T. Columns without a declared type (expressions) are accepted as any T.
+template<typename T, typename = void>
+struct column_traits;
+
+template<typename T>
+struct column_traits<T, typename std::enable_if<std::is_integral<T>::value>::type>
+{
+	static T get(sqlite3_stmt* stmt, int column) noexcept
+	{
+		return static_cast<T>(sqlite3_column_int64(stmt, column));
+	}
+	static constexpr bool accepts(column_affinity a) noexcept
+	{
+		return a == column_affinity::integer || a == column_affinity::numeric || a == column_affinity::blob;
+	}
+};
+
+template<typename T>
+struct column_traits<T, typename std::enable_if<std::is_floating_point<T>::value>::type>
+{
+	static T get(sqlite3_stmt* stmt, int column) noexcept
+	{
+		return static_cast<T>(sqlite3_column_double(stmt, column));
+	}
+	static constexpr bool accepts(column_affinity a) noexcept
+	{
+		return a != column_affinity::text;
+	}
+};
+
+template<>
+struct column_traits<std::string_view>
+{
+	// Valid until the next step.
+	static std::string_view get(sqlite3_stmt* stmt, int column) noexcept
+	{
+		auto p = reinterpret_cast<const char*>(sqlite3_column_text(stmt, column));
+		return p != nullptr ? std::string_view(p, static_cast<std::size_t>(sqlite3_column_bytes(stmt, column))) : std::string_view();
+	}
+	// Every value has a text form; NUMERIC columns such as DATETIME, DATE or
+	// DECIMAL commonly hold text.
+	static constexpr bool accepts(column_affinity) noexcept
+	{
+		return true;
+	}
+};
+
+template<>
+struct column_traits<std::string>
+{
+	static std::string get(sqlite3_stmt* stmt, int column)
+	{
+		return std::string(column_traits<std::string_view>::get(stmt, column));
+	}
+	static constexpr bool accepts(column_affinity a) noexcept
+	{
+		return column_traits<std::string_view>::accepts(a);
+	}
+};
+
+template<>
+struct column_traits<blob_view>
+{
+	// Valid until the next step.
+	static blob_view get(sqlite3_stmt* stmt, int column) noexcept
+	{
+		auto p = static_cast<const unsigned char*>(sqlite3_column_blob(stmt, column));
+		blob_view ret = { p, p != nullptr ? static_cast<std::size_t>(sqlite3_column_bytes(stmt, column)) : 0 };
+		return ret;
+	}
+	static constexpr bool accepts(column_affinity a) noexcept
+	{
+		return a == column_affinity::blob || a == column_affinity::text;
+	}
+};
+
+// NULL becomes std::nullopt. This is the only type that inspects
+// sqlite3_column_type per cell.
+template<typename T>
+struct column_traits<std::optional<T>>
+{
+	static std::optional<T> get(sqlite3_stmt* stmt, int column)
+	{
+		if (sqlite3_column_type(stmt, column) == SQLITE_NULL)
+			return std::nullopt;
+		return column_traits<T>::get(stmt, column);
+	}
+	static constexpr bool accepts(column_affinity a) noexcept
+	{
+		return column_traits<T>::accepts(a);
+	}
+};
+
+namespace detail
+{
+
+template<typename Row>
+struct row_traits;
+
+template<typename... T>
+struct row_traits<std::tuple<T...>>
+{
+	static constexpr int column_count = static_cast<int>(sizeof...(T));
+
+	static void check_columns(sqlite3_stmt* stmt)
+	{
+		if (sqlite3_column_count(stmt) != column_count)
+		{
+			throw std::system_error(SQLITE_RANGE, sqlite3_error_category(),
+				"result column count does not match the row type");
+		}
+		check_columns(stmt, std::index_sequence_for<T...>());
+	}
+
+	static std::tuple<T...> decode(sqlite3_stmt* stmt)
+	{
+		return decode(stmt, std::index_sequence_for<T...>());
+	}
+
+private:
+	template<std::size_t... I>
+	static void check_columns(sqlite3_stmt* stmt, std::index_sequence<I...>)
+	{
+		(check_column<T>(stmt, static_cast<int>(I)), ...);
+	}
+
+	template<typename U>
+	static void check_column(sqlite3_stmt* stmt, int column)
+	{
+		if (!column_traits<U>::accepts(affinity_of_decltype(sqlite3_column_decltype(stmt, column))))
+		{
+			const char* name = sqlite3_column_name(stmt, column);
+			throw std::system_error(SQLITE_MISMATCH, sqlite3_error_category(),
+				std::string("column ") + std::to_string(column) + " (" + (name != nullptr ? name : "") + ") has an incompatible declared type");
+		}
+	}
+
+	template<std::size_t... I>
+	static std::tuple<T...> decode(sqlite3_stmt* stmt, std::index_sequence<I...>)
+	{
+		return std::tuple<T...>(column_traits<T>::get(stmt, static_cast<int>(I))...);
+	}
+};
+
+template<typename T>
+void bind_argument(statement& stmt, int index, const T& value)
+{
+	if constexpr (std::is_integral<T>::value)
+		stmt.bind(index, static_cast<std::int64_t>(value));
+	else if constexpr (std::is_floating_point<T>::value)
+		stmt.bind(index, static_cast<double>(value));
+	else
+		stmt.bind(index, value);
+}
+
+} // namespace detail
+
+// A prepared SELECT whose result columns decode into Row (a std::tuple).
+// The column count and declared column types are checked once when the
+// statement is prepared; decoding a row is a fixed sequence of
+// sqlite3_column_* calls.
+template<typename Row>
+class typed_query
+{
+	typedef detail::row_traits<Row> traits;
+
+public:
+	class iterator
+	{
+	public:
+		typedef std::input_iterator_tag iterator_category;
+		typedef Row value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef const Row* pointer;
+		typedef Row reference;
+
+		iterator() noexcept : m_query() {}
+
+		Row operator*() const { return m_query->row(); }
+
+		iterator& operator++()
+		{
+			if (!m_query->next())
+				m_query = nullptr;
+			return *this;
+		}
+		void operator++(int) { ++*this; }
+
+		friend bool operator==(const iterator& x, const iterator& y) noexcept { return x.m_query == y.m_query; }
+		friend bool operator!=(const iterator& x, const iterator& y) noexcept { return x.m_query != y.m_query; }
+
+	private:
+		friend class typed_query;
+		explicit iterator(typed_query* q) noexcept : m_query(q) {}
+
+		typed_query* m_query;
+	};
+
+	typed_query(::sqlite3* db, const std::string& sql) : m_stmt(db, sql)
+	{
+		traits::check_columns(m_stmt.get());
+	}
+
+	explicit typed_query(statement&& stmt) : m_stmt(std::move(stmt))
+	{
+		traits::check_columns(m_stmt.get());
+	}
+
+	// Binds args to parameters 1, 2, ... and rewinds the statement.
+	template<typename... Args>
+	typed_query& bind(const Args&... args)
+	{
+		m_stmt.reset();
+		int index = 0;
+		(detail::bind_argument(m_stmt, ++index, args), ...);
+		return *this;
+	}
+
+	bool next() { return m_stmt.step(); }
+	Row row() const { return traits::decode(m_stmt.get()); }
+
+	// Iteration starts by stepping the statement; begin() may be called once
+	// per execution.
+	iterator begin() { return next() ? iterator(this) : iterator(); }
+	iterator end() noexcept { return iterator(); }
+
+	void reset() noexcept { m_stmt.reset(); }
+	statement& get_statement() noexcept { return m_stmt; }
+
+private:
+	statement m_stmt;
+};
+
+template<typename Row>
+typed_query<Row> query(::sqlite3* db, const std::string& sql)
+{
+	return typed_query<Row>(db, sql);
+}
+
+template<typename Row, typename... Args>
+typed_query<Row> query(::sqlite3* db, const std::string& sql, const Args&... args)
+{
+	typed_query<Row> q(db, sql);
+	q.bind(args...);
+	return q;
+}
+
+} // namespace sqlite3
+} // namespace konata
+
+#endif // KONATA_SQLITE3_QUERY_HPP
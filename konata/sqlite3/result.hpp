@@ -0,0 +1,148 @@
+/*
+sqlite3/result.hpp: Copyright (c) Egtra 2026
+
+Distributed under the Boost Software License, Version 1.0.
+(See accompanying file LICENSE.txt or copy at
+http://www.boost.org/LICENSE_1_0.txt )
+*/
+
+#ifndef KONATA_SQLITE3_RESULT_HPP
+#define KONATA_SQLITE3_RESULT_HPP
+
+#pragma once
+
+// Requires C++17.
+
+#include <optional>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <konata/sqlite3/connection.hpp>
+
+namespace konata
+{
+namespace sqlite3
+{
+
+// Either a T or a std::error_code (normally in sqlite3_error_category).
+// value() throws std::system_error when there is no value, so code that
+// does not branch on the error behaves like the throwing API.
+template<typename T>
+class result
+{
+public:
+	typedef T value_type;
+
+	result(const T& value) : m_value(value) {}
+	result(T&& value) : m_value(std::move(value)) {}
+	result(std::error_code ec) noexcept : m_error(ec) {}
+
+	bool has_value() const noexcept { return m_value.has_value(); }
+	explicit operator bool() const noexcept { return has_value(); }
+	const std::error_code& error() const noexcept { return m_error; }
+
+	T& value() &
+	{
+		throw_if_no_value();
+		return *m_value;
+	}
+	const T& value() const &
+	{
+		throw_if_no_value();
+		return *m_value;
+	}
+	T&& value() &&
+	{
+		throw_if_no_value();
+		return std::move(*m_value);
+	}
+
+	template<typename U>
+	T value_or(U&& alternative) const &
+	{
+		return has_value() ? *m_value : static_cast<T>(std::forward<U>(alternative));
+	}
+
+	T& operator*() noexcept { return *m_value; }
+	const T& operator*() const noexcept { return *m_value; }
+	T* operator->() noexcept { return &*m_value; }
+	const T* operator->() const noexcept { return &*m_value; }
+
+private:
+	void throw_if_no_value() const
+	{
+		if (!m_value)
+			throw std::system_error(m_error);
+	}
+
+	std::optional<T> m_value;
+	std::error_code m_error;
+};
+
+template<>
+class result<void>
+{
+public:
+	typedef void value_type;
+
+	result() noexcept {}
+	result(std::error_code ec) noexcept : m_error(ec) {}
+
+	bool has_value() const noexcept { return !m_error; }
+	explicit operator bool() const noexcept { return has_value(); }
+	const std::error_code& error() const noexcept { return m_error; }
+
+	void value() const
+	{
+		if (m_error)
+			throw std::system_error(m_error);
+	}
+
+private:
+	std::error_code m_error;
+};
+
+// Non-throwing counterparts of connection/statement operations.
+
+inline result<connection> try_open(const char* filename, int flags = SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, const char* vfs = nullptr) noexcept
+{
+	::sqlite3* db = nullptr;
+	int rc = sqlite3_open_v2(filename, &db, flags, vfs);
+	connection c(db);
+	if (rc != SQLITE_OK)
+		return make_error_code_from_result(rc);
+	return c;
+}
+
+inline result<statement> try_prepare(::sqlite3* db, const char* sql, int nbytes = -1, unsigned int prepFlags = 0) noexcept
+{
+	sqlite3_stmt* stmt = nullptr;
+	int rc = prepare_statement(db, sql, nbytes, prepFlags, &stmt);
+	statement s(stmt);
+	if (rc != SQLITE_OK)
+		return make_error_code_from_result(rc);
+	return s;
+}
+
+// true: a row is available; false: the statement has finished.
+inline result<bool> try_step(statement& stmt) noexcept
+{
+	int rc = stmt.raw_step();
+	if (rc == SQLITE_ROW)
+		return true;
+	if (rc == SQLITE_DONE)
+		return false;
+	return make_error_code_from_result(rc);
+}
+
+inline result<void> try_exec(::sqlite3* db, const char* sql) noexcept
+{
+	return make_error_code_from_result(sqlite3_exec(db, sql, nullptr, nullptr, nullptr));
+}
+
+} // namespace sqlite3
+} // namespace konata
+
+#endif // KONATA_SQLITE3_RESULT_HPP
@@ -0,0 +1,198 @@
+/*
+sqlite3/statement_cache.hpp: Copyright (c) Egtra 2026
+
+Distributed under the Boost Software License, Version 1.0.
+(See accompanying file LICENSE.txt or copy at
+http://www.boost.org/LICENSE_1_0.txt )
+*/
+
+#ifndef KONATA_SQLITE3_STATEMENT_CACHE_HPP
+#define KONATA_SQLITE3_STATEMENT_CACHE_HPP
+
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <utility> // move, pair
+
+#include <konata/sqlite3/connection.hpp>
+
+namespace konata
+{
+namespace sqlite3
+{
+
+// LRU cache of prepared statements keyed by SQL text.
+// A statement is lent out by acquire() and returned to the cache, reset and
+// with its bindings cleared, when the cached_statement goes out of scope.
+// Like the connection it belongs to, a cache must not be used by multiple
+// threads at once.
+class statement_cache
+{
+public:
+	class cached_statement
+	{
+	public:
+		cached_statement() noexcept : m_cache() {}
+
+		cached_statement(cached_statement&& y) noexcept
+			: m_cache(y.m_cache), m_sql(std::move(y.m_sql)), m_stmt(std::move(y.m_stmt))
+		{
+			y.m_cache = nullptr;
+		}
+
+		cached_statement& operator=(cached_statement&& y) noexcept
+		{
+			if (this != &y)
+			{
+				give_back();
+				m_cache = y.m_cache;
+				m_sql = std::move(y.m_sql);
+				m_stmt = std::move(y.m_stmt);
+				y.m_cache = nullptr;
+			}
+			return *this;
+		}
+
+		cached_statement(const cached_statement&) = delete;
+		cached_statement& operator=(const cached_statement&) = delete;
+
+		~cached_statement() { give_back(); }
+
+		statement& operator*() noexcept { return m_stmt; }
+		statement* operator->() noexcept { return &m_stmt; }
+		statement& get() noexcept { return m_stmt; }
+
+		// Finalize the statement instead of returning it to the cache.
+		void discard() noexcept
+		{
+			m_stmt.reset_handle();
+			m_cache = nullptr;
+		}
+
+	private:
+		friend class statement_cache;
+
+		cached_statement(statement_cache* cache, std::string&& sql, statement&& stmt) noexcept
+			: m_cache(cache), m_sql(std::move(sql)), m_stmt(std::move(stmt)) {}
+
+		void give_back() noexcept
+		{
+			if (m_cache != nullptr && m_stmt)
+				m_cache->put(std::move(m_sql), std::move(m_stmt));
+			m_cache = nullptr;
+		}
+
+		statement_cache* m_cache;
+		std::string m_sql;
+		statement m_stmt;
+	};
+
+	explicit statement_cache(::sqlite3* db, std::size_t capacity = 16)
+		: m_db(db), m_capacity(capacity), m_hits(), m_misses() {}
+
+	statement_cache(const statement_cache&) = delete;
+	statement_cache& operator=(const statement_cache&) = delete;
+
+	cached_statement acquire(const std::string& sql)
+	{
+		auto it = m_index.find(sql);
+		if (it != m_index.end())
+		{
+			++m_hits;
+			auto entry = it->second;
+			m_index.erase(it);
+			std::string key = std::move(entry->first);
+			statement stmt = std::move(entry->second);
+			m_lru.erase(entry);
+			return cached_statement(this, std::move(key), std::move(stmt));
+		}
+		++m_misses;
+		statement stmt;
+		stmt.prepare(m_db, sql.data(), static_cast<int>(sql.size()), prepare_flags());
+		return cached_statement(this, std::string(sql), std::move(stmt));
+	}
+
+	void clear() noexcept
+	{
+		m_index.clear();
+		m_lru.clear();
+	}
+
+	void set_capacity(std::size_t capacity) noexcept
+	{
+		m_capacity = capacity;
+		shrink();
+	}
+
+	std::size_t capacity() const noexcept { return m_capacity; }
+	std::size_t size() const noexcept { return m_lru.size(); }
+	std::size_t hits() const noexcept { return m_hits; }
+	std::size_t misses() const noexcept { return m_misses; }
+	void reset_counters() noexcept { m_hits = m_misses = 0; }
+
+	::sqlite3* db_handle() const noexcept { return m_db; }
+
+private:
+	typedef std::list<std::pair<std::string, statement>> lru_list;
+
+	static unsigned int prepare_flags() noexcept
+	{
+#ifdef SQLITE_PREPARE_PERSISTENT
+		return SQLITE_PREPARE_PERSISTENT;
+#else
+		return 0;
+#endif
+	}
+
+	void put(std::string&& sql, statement&& stmt) noexcept
+	{
+		stmt.reset();
+		stmt.clear_bindings();
+		if (m_capacity == 0)
+			return;
+		try
+		{
+			// Another lease for the same SQL may have been returned already.
+			if (m_index.find(sql) != m_index.end())
+				return;
+			m_lru.emplace_front(std::move(sql), std::move(stmt));
+			try
+			{
+				m_index.emplace(m_lru.front().first, m_lru.begin());
+			}
+			catch (...)
+			{
+				m_lru.pop_front();
+				throw;
+			}
+			shrink();
+		}
+		catch (...) // bad_alloc: drop the statement
+		{
+		}
+	}
+
+	void shrink() noexcept
+	{
+		while (m_lru.size() > m_capacity)
+		{
+			m_index.erase(m_lru.back().first);
+			m_lru.pop_back();
+		}
+	}
+
+	::sqlite3* m_db;
+	std::size_t m_capacity;
+	std::size_t m_hits;
+	std::size_t m_misses;
+	lru_list m_lru;
+	std::unordered_map<std::string, lru_list::iterator> m_index;
+};
+
+} // namespace sqlite3
+} // namespace konata
+
+#endif // KONATA_SQLITE3_STATEMENT_CACHE_HPP
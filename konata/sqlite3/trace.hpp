@@ -0,0 +1,389 @@
+/*
+sqlite3/trace.hpp: Copyright (c) Egtra 2026
+
+Distributed under the Boost Software License, Version 1.0.
+(See accompanying file LICENSE.txt or copy at
+http://www.boost.org/LICENSE_1_0.txt )
+*/
+
+#ifndef KONATA_SQLITE3_TRACE_HPP
+#define KONATA_SQLITE3_TRACE_HPP
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <konata/sqlite3/connection.hpp>
+
+namespace konata
+{
+namespace sqlite3
+{
+
+// Statistics of one normalized SQL text, as returned by
+// trace_collector::snapshot().
+struct statement_stats
+{
+	static const std::size_t bucket_count = 64;
+
+	std::string sql;
+	std::uint64_t calls;
+	std::uint64_t total_ns;
+	std::uint64_t max_ns;
+	std::uint64_t vm_steps;
+	std::uint64_t fullscan_steps;
+	std::uint64_t sorts;
+	std::uint64_t autoindexes;
+	// histogram[i] counts executions taking [2^i, 2^(i+1)) ns; [0] also counts 0 ns.
+	std::array<std::uint64_t, bucket_count> histogram;
+
+	// Upper bound of the bucket containing the given quantile (0.0 - 1.0).
+	std::uint64_t quantile_ns(double q) const noexcept
+	{
+		std::uint64_t n = 0;
+		for (auto c : histogram)
+			n += c;
+		if (n == 0)
+			return 0;
+		auto rank = static_cast<std::uint64_t>(q * static_cast<double>(n - 1)) + 1;
+		std::uint64_t seen = 0;
+		for (std::size_t i = 0; i < bucket_count; ++i)
+		{
+			seen += histogram[i];
+			if (seen >= rank)
+				return i + 1 < bucket_count ? (std::uint64_t(1) << (i + 1)) - 1 : UINT64_MAX;
+		}
+		return UINT64_MAX;
+	}
+};
+
+struct trace_snapshot
+{
+	std::uint64_t statements_started;
+	// Executions not accounted per statement because the table was full.
+	std::uint64_t dropped;
+	std::vector<statement_stats> statements;
+	// Error counts grouped by sqlite3_error_category().default_error_condition.
+	std::map<std::error_condition, std::uint64_t> errors;
+};
+
+// Collects per-statement latency histograms and sqlite3_stmt_status
+// counters through sqlite3_trace_v2 (SQLITE_TRACE_STMT | SQLITE_TRACE_PROFILE).
+// Recording is lock-free: statements are kept in a fixed-capacity
+// open-addressing table keyed by a hash of the normalized SQL, in which
+// literals are replaced by '?' and runs of whitespace by a single space.
+// The collector resets the stmt_status counters of the statements it
+// observes, and must outlive every connection attached to it.
+class trace_collector
+{
+public:
+	explicit trace_collector(std::size_t capacity = 1024)
+		: m_capacity(round_up_power_of_2(capacity)), m_entries(new entry[m_capacity]), m_started(0), m_dropped(0), m_errors()
+	{
+	}
+
+	trace_collector(const trace_collector&) = delete;
+	trace_collector& operator=(const trace_collector&) = delete;
+
+	void attach(::sqlite3* db)
+	{
+		throw_if_error(sqlite3_trace_v2(db, SQLITE_TRACE_STMT | SQLITE_TRACE_PROFILE, &trace_callback, this), db);
+	}
+
+	static void detach(::sqlite3* db) noexcept
+	{
+		sqlite3_trace_v2(db, 0, nullptr, nullptr);
+	}
+
+	void record_error(int rc) noexcept
+	{
+		if (is_error_result(rc))
+			m_errors[rc & 0xff].fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void record_error(const std::error_code& ec) noexcept
+	{
+		if (ec.category() == sqlite3_error_category())
+			record_error(ec.value());
+	}
+
+	// Routes every error SQLite reports through SQLITE_CONFIG_LOG to
+	// record_error(). Like sqlite3_config(), this must be called before
+	// sqlite3_initialize() (or after sqlite3_shutdown()); otherwise
+	// SQLITE_MISUSE is returned.
+	std::error_code log_errors_globally() noexcept
+	{
+		return make_error_code_from_result(sqlite3_config(SQLITE_CONFIG_LOG, &log_callback, this));
+	}
+
+	trace_snapshot snapshot() const
+	{
+		trace_snapshot s;
+		s.statements_started = m_started.load(std::memory_order_relaxed);
+		s.dropped = m_dropped.load(std::memory_order_relaxed);
+		for (std::size_t i = 0; i < m_capacity; ++i)
+		{
+			const entry& e = m_entries[i];
+			if (!e.ready.load(std::memory_order_acquire))
+				continue;
+			statement_stats st;
+			st.sql = e.sql;
+			st.calls = e.calls.load(std::memory_order_relaxed);
+			st.total_ns = e.total_ns.load(std::memory_order_relaxed);
+			st.max_ns = e.max_ns.load(std::memory_order_relaxed);
+			st.vm_steps = e.vm_steps.load(std::memory_order_relaxed);
+			st.fullscan_steps = e.fullscan_steps.load(std::memory_order_relaxed);
+			st.sorts = e.sorts.load(std::memory_order_relaxed);
+			st.autoindexes = e.autoindexes.load(std::memory_order_relaxed);
+			for (std::size_t b = 0; b < statement_stats::bucket_count; ++b)
+				st.histogram[b] = e.histogram[b].load(std::memory_order_relaxed);
+			s.statements.push_back(std::move(st));
+		}
+		for (int rc = 0; rc < 256; ++rc)
+		{
+			auto n = m_errors[rc].load(std::memory_order_relaxed);
+			if (n != 0)
+				s.errors[sqlite3_error_category().default_error_condition(rc)] += n;
+		}
+		return s;
+	}
+
+	// One line per statement: calls, total/max/p50/p99 in ns, counters, SQL.
+	template<typename Ch, typename Traits>
+	void export_text(std::basic_ostream<Ch, Traits>& os) const
+	{
+		auto s = snapshot();
+		os << "started " << s.statements_started << " dropped " << s.dropped << '\n';
+		for (const auto& st : s.statements)
+		{
+			os << st.calls << ' ' << st.total_ns << ' ' << st.max_ns
+				<< ' ' << st.quantile_ns(0.5) << ' ' << st.quantile_ns(0.99)
+				<< ' ' << st.vm_steps << ' ' << st.fullscan_steps
+				<< ' ' << st.sorts << ' ' << st.autoindexes
+				<< ' ' << st.sql.c_str() << '\n';
+		}
+		for (const auto& e : s.errors)
+			os << "error " << e.first.category().name() << ':' << e.first.value() << ' ' << e.second << '\n';
+	}
+
+	static std::string normalize(const char* sql)
+	{
+		std::string ret;
+		scan(sql, [&ret](char c) { ret += c; });
+		return ret;
+	}
+
+private:
+	struct entry
+	{
+		entry() noexcept
+			: hash(0), ready(false), calls(0), total_ns(0), max_ns(0)
+			, vm_steps(0), fullscan_steps(0), sorts(0), autoindexes(0), histogram()
+		{
+		}
+
+		std::atomic<std::uint64_t> hash; // 0: empty
+		std::atomic<bool> ready; // sql has been written
+		std::string sql;
+		std::atomic<std::uint64_t> calls;
+		std::atomic<std::uint64_t> total_ns;
+		std::atomic<std::uint64_t> max_ns;
+		std::atomic<std::uint64_t> vm_steps;
+		std::atomic<std::uint64_t> fullscan_steps;
+		std::atomic<std::uint64_t> sorts;
+		std::atomic<std::uint64_t> autoindexes;
+		std::atomic<std::uint64_t> histogram[statement_stats::bucket_count];
+	};
+
+	static std::size_t round_up_power_of_2(std::size_t n) noexcept
+	{
+		std::size_t ret = 16;
+		while (ret < n)
+			ret <<= 1;
+		return ret;
+	}
+
+	static bool is_identifier_char(char c) noexcept
+	{
+		return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '$' || (c & 0x80) != 0;
+	}
+
+	static bool is_space(char c) noexcept
+	{
+		return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+	}
+
+	// Feeds the normalized form of sql to out, one character at a time.
+	template<typename Out>
+	static void scan(const char* p, Out out)
+	{
+		bool pendingSpace = false;
+		bool started = false;
+		char prev = '\0';
+		auto emit = [&](char c)
+		{
+			if (pendingSpace && started)
+				out(' ');
+			pendingSpace = false;
+			started = true;
+			out(c);
+			prev = c;
+		};
+		while (*p != '\0')
+		{
+			char c = *p;
+			if (is_space(c))
+			{
+				pendingSpace = true;
+				prev = ' ';
+				++p;
+			}
+			else if (c == '\'' || ((c == 'x' || c == 'X') && p[1] == '\'' && !is_identifier_char(prev)))
+			{
+				// string or blob literal
+				if (c != '\'')
+					++p;
+				for (++p; *p != '\0'; ++p)
+				{
+					if (*p == '\'' && *++p != '\'')
+						break;
+				}
+				emit('?');
+			}
+			else if (c >= '0' && c <= '9' && !is_identifier_char(prev))
+			{
+				while (is_identifier_char(*p) || *p == '.' || ((*p == '+' || *p == '-') && (p[-1] == 'e' || p[-1] == 'E')))
+					++p;
+				emit('?');
+			}
+			else
+			{
+				emit(c);
+				++p;
+			}
+		}
+	}
+
+	static std::uint64_t hash_normalized(const char* sql) noexcept
+	{
+		// FNV-1a
+		std::uint64_t h = 14695981039346656037u;
+		scan(sql, [&h](char c) { h = (h ^ static_cast<unsigned char>(c)) * 1099511628211u; });
+		return h != 0 ? h : 1;
+	}
+
+	entry* find_or_insert(const char* sql) noexcept
+	{
+		auto h = hash_normalized(sql);
+		std::size_t mask = m_capacity - 1;
+		for (std::size_t i = 0; i < m_capacity; ++i)
+		{
+			entry& e = m_entries[(h + i) & mask];
+			auto current = e.hash.load(std::memory_order_acquire);
+			if (current == h)
+				return &e;
+			if (current == 0)
+			{
+				std::uint64_t expected = 0;
+				if (e.hash.compare_exchange_strong(expected, h, std::memory_order_acq_rel))
+				{
+					try
+					{
+						e.sql = normalize(sql);
+					}
+					catch (...) // bad_alloc: keep counting without the text
+					{
+					}
+					e.ready.store(true, std::memory_order_release);
+					return &e;
+				}
+				if (expected == h)
+					return &e;
+			}
+		}
+		return nullptr;
+	}
+
+	static void update_max(std::atomic<std::uint64_t>& target, std::uint64_t value) noexcept
+	{
+		auto current = target.load(std::memory_order_relaxed);
+		while (current < value && !target.compare_exchange_weak(current, value, std::memory_order_relaxed))
+		{
+		}
+	}
+
+	static std::size_t bucket_of(std::uint64_t ns) noexcept
+	{
+		std::size_t b = 0;
+		while (ns > 1)
+		{
+			ns >>= 1;
+			++b;
+		}
+		return b;
+	}
+
+	void record_profile(sqlite3_stmt* stmt, std::uint64_t ns) noexcept
+	{
+		const char* sql = sqlite3_sql(stmt);
+		entry* e = sql != nullptr ? find_or_insert(sql) : nullptr;
+		if (e == nullptr)
+		{
+			m_dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		e->calls.fetch_add(1, std::memory_order_relaxed);
+		e->total_ns.fetch_add(ns, std::memory_order_relaxed);
+		update_max(e->max_ns, ns);
+		e->histogram[bucket_of(ns)].fetch_add(1, std::memory_order_relaxed);
+		e->vm_steps.fetch_add(static_cast<std::uint64_t>(sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_VM_STEP, 1)), std::memory_order_relaxed);
+		e->fullscan_steps.fetch_add(static_cast<std::uint64_t>(sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_FULLSCAN_STEP, 1)), std::memory_order_relaxed);
+		e->sorts.fetch_add(static_cast<std::uint64_t>(sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_SORT, 1)), std::memory_order_relaxed);
+		e->autoindexes.fetch_add(static_cast<std::uint64_t>(sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_AUTOINDEX, 1)), std::memory_order_relaxed);
+	}
+
+	static int trace_callback(unsigned int type, void* context, void* p, void* x)
+	{
+		auto pthis = static_cast<trace_collector*>(context);
+		if (type == SQLITE_TRACE_STMT)
+		{
+			// Trigger subprograms report their "-- name" comment; count top-level statements only.
+			auto text = static_cast<const char*>(x);
+			if (text == nullptr || text[0] != '-' || text[1] != '-')
+				pthis->m_started.fetch_add(1, std::memory_order_relaxed);
+		}
+		else if (type == SQLITE_TRACE_PROFILE)
+		{
+			pthis->record_profile(static_cast<sqlite3_stmt*>(p), static_cast<std::uint64_t>(*static_cast<sqlite3_int64*>(x)));
+		}
+		return 0;
+	}
+
+	static void log_callback(void* context, int rc, const char*)
+	{
+		auto primary = rc & 0xff;
+		if (primary != SQLITE_NOTICE && primary != SQLITE_WARNING)
+			static_cast<trace_collector*>(context)->record_error(rc);
+	}
+
+	std::size_t m_capacity;
+	std::unique_ptr<entry[]> m_entries;
+	std::atomic<std::uint64_t> m_started;
+	std::atomic<std::uint64_t> m_dropped;
+	std::atomic<std::uint64_t> m_errors[256];
+};
+
+} // namespace sqlite3
+} // namespace konata
+
+#endif // KONATA_SQLITE3_TRACE_HPP
@@ -0,0 +1,122 @@
+// test/jni/string_bench.cpp
+//
+// Copyright (c) Egtra 2026
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt )
+
+// Cost of reading a jstring through each access mode, against a JVM
+// started in this process: GetStringChars, GetStringUTFChars and
+// GetStringCritical through their scoped pointers, and copies into a
+// reused buffer with GetStringRegion and GetStringUTFRegion. Each mode
+// also touches every unit, as a caller would. Reported in ns per string,
+// per kind of text and length in UTF-16 units.
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <konata/jni/java_vm.hpp>
+#include <konata/jni/string.hpp>
+
+namespace
+{
+
+// Keeps the reads from being optimized away.
+volatile unsigned sink;
+
+template<typename F>
+double measure(F f)
+{
+	typedef std::chrono::steady_clock clock;
+	std::size_t iterations = 0;
+	auto start = clock::now();
+	auto elapsed = clock::duration::zero();
+	do
+	{
+		for (int i = 0; i < 64; ++i)
+			sink = f();
+		iterations += 64;
+		elapsed = clock::now() - start;
+	} while (elapsed < std::chrono::milliseconds(200));
+	return std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(iterations);
+}
+
+template<typename CharT>
+unsigned sum(const CharT* p, std::size_t n)
+{
+	unsigned s = 0;
+	for (std::size_t i = 0; i < n; ++i)
+		s += static_cast<unsigned>(p[i]);
+	return s;
+}
+
+std::vector<jchar> make_text(bool ascii, std::size_t n)
+{
+	std::vector<jchar> s(n);
+	for (std::size_t i = 0; i < n; ++i)
+		s[i] = static_cast<jchar>(ascii ? 0x61 + i % 26 : 0x4E00 + (i * 7919) % 0x5000);
+	return s;
+}
+
+void run(JNIEnv* env)
+{
+	static const std::size_t lengths[] = { 8, 64, 512, 4096, 65536 };
+	std::printf("%-6s %6s %16s %18s %18s %16s %19s\n", "text", "length",
+		"GetStringChars", "GetStringUTFChars", "GetStringCritical", "GetStringRegion", "GetStringUTFRegion");
+	std::vector<jchar> units;
+	std::vector<char> bytes;
+	for (int ascii = 1; ascii >= 0; --ascii)
+	{
+		for (std::size_t length : lengths)
+		{
+			std::vector<jchar> text = make_text(ascii != 0, length);
+			jstring str = env->NewString(text.data(), static_cast<jsize>(length));
+
+			double chars = measure([&] {
+				konata::jni::scoped_chars_ptr p = konata::jni::GetStringChars(env, str, 0);
+				return sum(p.get(), static_cast<std::size_t>(env->GetStringLength(str)));
+			});
+			double utfChars = measure([&] {
+				konata::jni::scoped_utf_chars_ptr p = konata::jni::GetStringUTFChars(env, str, 0);
+				return sum(p.get(), std::strlen(p.get()));
+			});
+			double critical = measure([&] {
+				jsize m = env->GetStringLength(str);
+				konata::jni::scoped_critical_ptr p = konata::jni::GetStringCritical(env, str, 0);
+				return sum(p.get(), static_cast<std::size_t>(m));
+			});
+			double region = measure([&] {
+				jsize m = env->GetStringLength(str);
+				units.resize(static_cast<std::size_t>(m));
+				env->GetStringRegion(str, 0, m, units.data());
+				return sum(units.data(), units.size());
+			});
+			double utfRegion = measure([&] {
+				jsize m = env->GetStringLength(str);
+				std::size_t size = static_cast<std::size_t>(env->GetStringUTFLength(str));
+				bytes.resize(size + 1);
+				env->GetStringUTFRegion(str, 0, m, bytes.data());
+				return sum(bytes.data(), size);
+			});
+			std::printf("%-6s %6d %16.1f %18.1f %18.1f %16.1f %19.1f\n", ascii ? "ascii" : "cjk", static_cast<int>(length),
+				chars, utfChars, critical, region, utfRegion);
+			env->DeleteLocalRef(str);
+		}
+	}
+}
+
+} // unnamed namespace
+
+int main()
+{
+	konata::jni::embedded_java_vm vm((std::vector<std::string>()));
+	if (!vm)
+	{
+		std::printf("JNI_CreateJavaVM failed: %d\n", static_cast<int>(vm.result()));
+		return 1;
+	}
+	run(vm.env());
+}
@@ -0,0 +1,214 @@
+// test/jni/string_test.cpp
+//
+// Copyright (c) Egtra 2026
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt )
+
+// Checks scoped_chars_ptr, scoped_utf_chars_ptr and scoped_critical_ptr
+// against a JVM started in this process (-Xcheck:jni, so that misuse of
+// the JNI functions is reported by the VM), with non-ASCII, NUL and
+// surrogate strings.
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+#include <konata/jni/env.hpp>
+#include <konata/jni/java_vm.hpp>
+#include <konata/jni/string.hpp>
+#include <konata/jni/transcode.hpp>
+
+namespace
+{
+
+int failures = 0;
+
+void check(bool ok, const char* name, const char* what)
+{
+	if (!ok)
+	{
+		++failures;
+		std::printf("FAIL %s: %s\n", name, what);
+	}
+}
+
+// A string as UTF-16 and as the modified UTF-8 the JVM hands out.
+struct string_case
+{
+	const char* name;
+	std::vector<jchar> utf16;
+	std::string modified;
+};
+
+// Modified UTF-8, one UTF-16 unit at a time, for strings built by repetition.
+std::string reference_modified(const std::vector<jchar>& s, std::size_t begin, std::size_t end)
+{
+	std::string out;
+	for (std::size_t i = begin; i < end; ++i)
+	{
+		unsigned u = s[i];
+		if (u != 0 && u < 0x80)
+		{
+			out += static_cast<char>(u);
+		}
+		else if (u < 0x800)
+		{
+			out += static_cast<char>(0xC0 | (u >> 6));
+			out += static_cast<char>(0x80 | (u & 0x3F));
+		}
+		else
+		{
+			out += static_cast<char>(0xE0 | (u >> 12));
+			out += static_cast<char>(0x80 | ((u >> 6) & 0x3F));
+			out += static_cast<char>(0x80 | (u & 0x3F));
+		}
+	}
+	return out;
+}
+
+std::vector<string_case> make_cases()
+{
+	std::vector<string_case> cases;
+	string_case fixed[] =
+	{
+		{ "empty", {}, std::string() },
+		{ "ascii", { 'k', 'o', 'n', 'a', 't', 'a' }, "konata" },
+		{ "latin", { 'c', 'a', 'f', 0xE9 }, "caf\xC3\xA9" },
+		{ "cjk", { 0x65E5, 0x672C, 0x8A9E }, "\xE6\x97\xA5\xE6\x9C\xAC\xE8\xAA\x9E" },
+		{ "supplementary", { 0xD83D, 0xDE00, '!' }, "\xED\xA0\xBD\xED\xB8\x80!" },
+		{ "nul", { 'a', 0, 'b' }, std::string("a\xC0\x80" "b") },
+		{ "unpaired high", { 0xD800, 'x' }, "\xED\xA0\x80x" },
+		{ "unpaired low", { 'x', 0xDC00 }, "x\xED\xB0\x80" },
+		{ "reversed pair", { 0xDE00, 0xD83D }, "\xED\xB8\x80\xED\xA0\xBD" },
+	};
+	cases.assign(fixed, fixed + sizeof fixed / sizeof fixed[0]);
+
+	string_case mixed = { "long mixed", {}, std::string() };
+	const jchar piece[] = { 'a', 'b', 'c', 0xE9, 0x3042, 0xD83D, 0xDE00, 0, 'z' };
+	for (int i = 0; i < 20000; ++i)
+		mixed.utf16.insert(mixed.utf16.end(), piece, piece + sizeof piece / sizeof piece[0]);
+	mixed.modified = reference_modified(mixed.utf16, 0, mixed.utf16.size());
+	cases.push_back(mixed);
+	return cases;
+}
+
+bool same_units(const jchar* p, const std::vector<jchar>& expected)
+{
+	return expected.empty() || std::memcmp(p, expected.data(), expected.size() * sizeof(jchar)) == 0;
+}
+
+void test_case(JNIEnv* env, const string_case& c)
+{
+	konata::jni::local_frame frame(env, 8);
+	jsize length = static_cast<jsize>(c.utf16.size());
+	jstring str = env->NewString(c.utf16.data(), length);
+	check(str != 0, c.name, "NewString");
+	if (str == 0)
+		return;
+	check(env->GetStringLength(str) == length, c.name, "GetStringLength");
+
+	{
+		jboolean isCopy = JNI_FALSE;
+		konata::jni::scoped_chars_ptr p = konata::jni::GetStringChars(env, str, &isCopy);
+		check(p != nullptr, c.name, "GetStringChars returned null");
+		if (p != nullptr)
+			check(same_units(p.get(), c.utf16), c.name, "GetStringChars contents");
+		konata::jni::scoped_chars_ptr q = std::move(p);
+		check(p == nullptr && q != nullptr, c.name, "scoped_chars_ptr move");
+	}
+
+	{
+		std::vector<jchar> copy;
+		{
+			jboolean isCopy = JNI_FALSE;
+			konata::jni::scoped_critical_ptr p = konata::jni::GetStringCritical(env, str, &isCopy);
+			// No JNI calls until p is released.
+			if (p != nullptr)
+				copy.assign(p.get(), p.get() + length);
+			check(p != nullptr, c.name, "GetStringCritical returned null");
+		}
+		check(copy == c.utf16, c.name, "GetStringCritical contents");
+	}
+
+	{
+		jboolean isCopy = JNI_FALSE;
+		konata::jni::scoped_utf_chars_ptr p = konata::jni::GetStringUTFChars(env, str, &isCopy);
+		check(p != nullptr, c.name, "GetStringUTFChars returned null");
+		if (p != nullptr)
+		{
+			std::size_t n = static_cast<std::size_t>(env->GetStringUTFLength(str));
+			check(n == c.modified.size(), c.name, "GetStringUTFLength");
+			check(std::strlen(p.get()) == c.modified.size(), c.name, "GetStringUTFChars has a NUL inside");
+			check(c.modified.compare(0, std::string::npos, p.get(), std::strlen(p.get())) == 0, c.name, "GetStringUTFChars contents");
+
+			// The JVM's modified UTF-8 and konata's transcoder agree.
+			std::vector<char> fromJvm(c.modified.size() + 1);
+			fromJvm.resize(konata::jni::modified_utf8_to_utf8(p.get(), n, fromJvm.data()));
+			std::vector<char> fromUtf16(3 * c.utf16.size() + 1);
+			fromUtf16.resize(konata::jni::utf16_to_utf8(c.utf16.data(), c.utf16.size(), fromUtf16.data()));
+			check(fromJvm == fromUtf16, c.name, "modified_utf8_to_utf8 of GetStringUTFChars");
+		}
+	}
+
+	// Region copies, of the whole string and of a middle part.
+	{
+		std::vector<jchar> units(c.utf16.size() + 1);
+		env->GetStringRegion(str, 0, length, units.data());
+		units.pop_back();
+		check(units == c.utf16, c.name, "GetStringRegion");
+
+		std::vector<char> bytes(c.modified.size() + 1, '\x7F');
+		env->GetStringUTFRegion(str, 0, length, bytes.data());
+		check(std::string(bytes.data(), c.modified.size()) == c.modified && bytes.back() == 0, c.name, "GetStringUTFRegion");
+
+		if (length >= 3)
+		{
+			jsize start = 1;
+			jsize count = length - 2;
+			std::string expected = reference_modified(c.utf16, start, start + count);
+			std::vector<char> part(expected.size() + 1);
+			env->GetStringUTFRegion(str, start, count, part.data());
+			check(std::string(part.data(), expected.size()) == expected, c.name, "GetStringUTFRegion of a substring");
+		}
+	}
+
+	// Back through NewStringUTF, which takes modified UTF-8.
+	{
+		jstring back = env->NewStringUTF(c.modified.c_str());
+		check(back != 0, c.name, "NewStringUTF");
+		if (back != 0)
+		{
+			konata::jni::scoped_chars_ptr p = konata::jni::GetStringChars(env, back, 0);
+			check(env->GetStringLength(back) == length && p != nullptr && same_units(p.get(), c.utf16), c.name, "NewStringUTF round trip");
+		}
+	}
+
+	check(!env->ExceptionCheck(), c.name, "exception pending");
+	if (env->ExceptionCheck())
+	{
+		env->ExceptionDescribe();
+		env->ExceptionClear();
+	}
+}
+
+} // unnamed namespace
+
+int main()
+{
+	std::vector<std::string> options;
+	options.push_back("-Xcheck:jni");
+	konata::jni::embedded_java_vm vm(options);
+	if (!vm)
+	{
+		std::printf("JNI_CreateJavaVM failed: %d\n", static_cast<int>(vm.result()));
+		return 1;
+	}
+	std::vector<string_case> cases = make_cases();
+	for (std::size_t i = 0; i < cases.size(); ++i)
+		test_case(vm.env(), cases[i]);
+	std::printf("%d failures\n", failures);
+	return failures == 0 ? 0 : 1;
+}
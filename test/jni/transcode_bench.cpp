@@ -0,0 +1,115 @@
+// test/jni/transcode_bench.cpp
+//
+// Copyright (c) Egtra 2026
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt )
+
+// Throughput of the six conversions of konata/jni/transcode.hpp, per
+// kernel set, kind of text and length in UTF-16 units, in MB/s of input.
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include <konata/jni/transcode.hpp>
+
+namespace
+{
+
+using konata::jni::transcode_isa;
+namespace detail = konata::jni::detail;
+
+const char* const isa_names[] = { "scalar", "sse4_1", "avx2" };
+
+// Mostly ASCII (identifiers, JSON), Latin with accents, and CJK.
+std::vector<jchar> make_text(int kind, std::size_t n)
+{
+	std::mt19937 g(kind);
+	std::vector<jchar> s;
+	while (s.size() < n)
+	{
+		unsigned r = g() % 100;
+		if (kind == 0)
+			s.push_back(static_cast<jchar>(r < 98 ? 0x20 + g() % 0x5F : 0xE0 + g() % 0x20));
+		else if (kind == 1)
+			s.push_back(static_cast<jchar>(r < 80 ? 0x61 + g() % 26 : 0xC0 + g() % 0x40));
+		else
+			s.push_back(static_cast<jchar>(r < 10 ? 0x20 + g() % 0x5F : 0x4E00 + g() % 0x5000));
+	}
+	return s;
+}
+
+const char* const kind_names[] = { "ascii", "latin", "cjk" };
+
+// Keeps the conversions from being optimized away.
+volatile std::size_t sink;
+
+template<typename F>
+void measure(const char* name, const char* kind, std::size_t length, std::size_t inputBytes, F f)
+{
+	typedef std::chrono::steady_clock clock;
+	std::size_t iterations = 0;
+	auto start = clock::now();
+	auto elapsed = clock::duration::zero();
+	do
+	{
+		for (int i = 0; i < 64; ++i)
+			sink = f();
+		iterations += 64;
+		elapsed = clock::now() - start;
+	} while (elapsed < std::chrono::milliseconds(200));
+	double seconds = std::chrono::duration<double>(elapsed).count();
+	std::printf("  %-24s %-6s %8u %10.1f MB/s\n", name, kind, static_cast<unsigned>(length),
+		static_cast<double>(inputBytes) * static_cast<double>(iterations) / seconds / 1e6);
+}
+
+void run()
+{
+	static const std::size_t lengths[] = { 16, 256, 4096, 1 << 20 };
+	for (int kind = 0; kind < 3; ++kind)
+	{
+		for (std::size_t length : lengths)
+		{
+			std::vector<jchar> utf16 = make_text(kind, length);
+			std::vector<char> modified(3 * length);
+			modified.resize(konata::jni::utf16_to_modified_utf8(utf16.data(), length, modified.data()));
+			std::vector<char> utf8(3 * length);
+			utf8.resize(konata::jni::utf16_to_utf8(utf16.data(), length, utf8.data()));
+			std::vector<char> out8(3 * modified.size() + 3 * length);
+			std::vector<jchar> out16(modified.size());
+			const char* k = kind_names[kind];
+
+			measure("modified_utf8_to_utf8", k, length, modified.size(),
+				[&] { return konata::jni::modified_utf8_to_utf8(modified.data(), modified.size(), out8.data()); });
+			measure("utf8_to_modified_utf8", k, length, utf8.size(),
+				[&] { return konata::jni::utf8_to_modified_utf8(utf8.data(), utf8.size(), out8.data()); });
+			measure("utf8_to_utf16", k, length, utf8.size(),
+				[&] { return konata::jni::utf8_to_utf16(utf8.data(), utf8.size(), out16.data()); });
+			measure("modified_utf8_to_utf16", k, length, modified.size(),
+				[&] { return konata::jni::modified_utf8_to_utf16(modified.data(), modified.size(), out16.data()); });
+			measure("utf16_to_utf8", k, length, 2 * length,
+				[&] { return konata::jni::utf16_to_utf8(utf16.data(), length, out8.data()); });
+			measure("utf16_to_modified_utf8", k, length, 2 * length,
+				[&] { return konata::jni::utf16_to_modified_utf8(utf16.data(), length, out8.data()); });
+		}
+	}
+}
+
+} // unnamed namespace
+
+int main()
+{
+	transcode_isa detected = konata::jni::active_transcode_isa();
+	for (int i = 0; i <= static_cast<int>(detected); ++i)
+	{
+		detail::transcode_kernels kernels = detail::make_transcode_kernels(static_cast<transcode_isa>(i));
+		if (static_cast<int>(kernels.isa) != i)
+			continue;
+		detail::transcode_kernels_override() = &kernels;
+		std::printf("%s\n", isa_names[i]);
+		run();
+	}
+	detail::transcode_kernels_override() = nullptr;
+}
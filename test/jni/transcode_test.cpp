@@ -0,0 +1,454 @@
+// test/jni/transcode_test.cpp
+//
+// Copyright (c) Egtra 2026
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt )
+
+// Checks the six conversions of konata/jni/transcode.hpp with each kernel
+// set the CPU can run forced in turn. Every case is also run surrounded by
+// ASCII runs of several lengths, so that the vector kernels meet it at
+// every position within a block.
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include <konata/jni/transcode.hpp>
+
+namespace
+{
+
+using konata::jni::transcode_isa;
+
+enum direction
+{
+	modified_to_utf8,
+	utf8_to_modified,
+	utf8_to_utf16,
+	modified_to_utf16,
+	utf16_to_utf8,
+	utf16_to_modified,
+};
+
+const char* const direction_names[] =
+{
+	"modified_utf8_to_utf8",
+	"utf8_to_modified_utf8",
+	"utf8_to_utf16",
+	"modified_utf8_to_utf16",
+	"utf16_to_utf8",
+	"utf16_to_modified_utf8",
+};
+
+const char* const isa_names[] = { "scalar", "sse4_1", "avx2" };
+
+// Bytes or UTF-16 code units, depending on the side of the conversion.
+typedef std::vector<unsigned> units;
+
+int failures = 0;
+const char* current_isa = "";
+
+bool from_utf16(direction d)
+{
+	return d == utf16_to_utf8 || d == utf16_to_modified;
+}
+
+bool to_utf16(direction d)
+{
+	return d == utf8_to_utf16 || d == modified_to_utf16;
+}
+
+units convert(direction d, const units& in)
+{
+	std::size_t n = in.size();
+	if (from_utf16(d))
+	{
+		std::vector<jchar> input(in.begin(), in.end());
+		std::vector<char> output(3 * n + 1);
+		std::size_t m = d == utf16_to_utf8
+			? konata::jni::utf16_to_utf8(input.data(), n, output.data())
+			: konata::jni::utf16_to_modified_utf8(input.data(), n, output.data());
+		units result;
+		for (std::size_t i = 0; i < m; ++i)
+			result.push_back(static_cast<unsigned char>(output[i]));
+		return result;
+	}
+	std::vector<char> input(in.begin(), in.end());
+	if (to_utf16(d))
+	{
+		std::vector<jchar> output(n + 1);
+		std::size_t m = d == utf8_to_utf16
+			? konata::jni::utf8_to_utf16(input.data(), n, output.data())
+			: konata::jni::modified_utf8_to_utf16(input.data(), n, output.data());
+		return units(output.begin(), output.begin() + m);
+	}
+	std::vector<char> output(3 * n + 1);
+	std::size_t m = d == modified_to_utf8
+		? konata::jni::modified_utf8_to_utf8(input.data(), n, output.data())
+		: konata::jni::utf8_to_modified_utf8(input.data(), n, output.data());
+	units result;
+	for (std::size_t i = 0; i < m; ++i)
+		result.push_back(static_cast<unsigned char>(output[i]));
+	return result;
+}
+
+// Modified UTF-8 -> standard UTF-8 in place; only for input as the JVM
+// produces it, which never grows.
+units convert_in_place(const units& in)
+{
+	std::vector<char> buffer(in.begin(), in.end());
+	std::size_t m = konata::jni::modified_utf8_to_utf8(buffer.data(), buffer.size(), buffer.data());
+	units result;
+	for (std::size_t i = 0; i < m; ++i)
+		result.push_back(static_cast<unsigned char>(buffer[i]));
+	return result;
+}
+
+std::string dump(const units& u)
+{
+	std::string s;
+	char buf[8];
+	for (std::size_t i = 0; i < u.size(); ++i)
+	{
+		std::snprintf(buf, sizeof buf, i == 0 ? "%02X" : " %02X", u[i]);
+		s += buf;
+	}
+	return s;
+}
+
+void report(const char* name, const char* what, std::size_t pad, const units& expected, const units& actual)
+{
+	++failures;
+	std::printf("FAIL %s: %s [%s] pad %u\n  expected %s\n  actual   %s\n",
+		name, what, current_isa, static_cast<unsigned>(pad), dump(expected).c_str(), dump(actual).c_str());
+}
+
+units padding(std::size_t n)
+{
+	units u;
+	for (std::size_t i = 0; i < n; ++i)
+		u.push_back('a' + i % 26);
+	return u;
+}
+
+units concat(const units& a, const units& b, const units& c)
+{
+	units u(a);
+	u.insert(u.end(), b.begin(), b.end());
+	u.insert(u.end(), c.begin(), c.end());
+	return u;
+}
+
+const std::size_t pads[] = { 0, 1, 7, 15, 16, 17, 31, 32, 33, 47, 64 };
+
+void expect(const char* name, direction d, const units& in, const units& expected)
+{
+	for (std::size_t pad : pads)
+	{
+		units before = padding(pad);
+		units after = padding(pad + 3);
+		units actual = convert(d, concat(before, in, after));
+		units wanted = concat(before, expected, after);
+		if (actual != wanted)
+			report(name, direction_names[d], pad, wanted, actual);
+	}
+}
+
+void expect_in_place(const char* name, const units& in, const units& expected)
+{
+	for (std::size_t pad : pads)
+	{
+		units before = padding(pad);
+		units actual = convert_in_place(concat(before, in, before));
+		units wanted = concat(before, expected, before);
+		if (actual != wanted)
+			report(name, "modified_utf8_to_utf8 in place", pad, wanted, actual);
+	}
+}
+
+// A UTF-16 string with its standard and modified UTF-8 forms. Strings with
+// unpaired surrogates cannot come back from standard UTF-8.
+struct string_case
+{
+	const char* name;
+	units utf16;
+	units utf8;
+	units modified;
+	bool paired;
+};
+
+const string_case string_cases[] =
+{
+	{ "empty", {}, {}, {}, true },
+	{ "ascii", { 'J', 'N', 'I' }, { 'J', 'N', 'I' }, { 'J', 'N', 'I' }, true },
+	{ "nul", { 0 }, { 0 }, { 0xC0, 0x80 }, true },
+	{ "nul run", { 0, 0, 'x', 0 }, { 0, 0, 'x', 0 }, { 0xC0, 0x80, 0xC0, 0x80, 'x', 0xC0, 0x80 }, true },
+	{ "two bytes", { 0xE9, 0x7FF }, { 0xC3, 0xA9, 0xDF, 0xBF }, { 0xC3, 0xA9, 0xDF, 0xBF }, true },
+	{ "three bytes", { 0x800, 0x3042, 0xFFFD, 0xFFFF }, { 0xE0, 0xA0, 0x80, 0xE3, 0x81, 0x82, 0xEF, 0xBF, 0xBD, 0xEF, 0xBF, 0xBF },
+		{ 0xE0, 0xA0, 0x80, 0xE3, 0x81, 0x82, 0xEF, 0xBF, 0xBD, 0xEF, 0xBF, 0xBF }, true },
+	{ "supplementary", { 0xD83D, 0xDE00 }, { 0xF0, 0x9F, 0x98, 0x80 }, { 0xED, 0xA0, 0xBD, 0xED, 0xB8, 0x80 }, true },
+	{ "last code point", { 0xDBFF, 0xDFFF }, { 0xF4, 0x8F, 0xBF, 0xBF }, { 0xED, 0xAF, 0xBF, 0xED, 0xBF, 0xBF }, true },
+	{ "mixed", { 'a', 0, 0xE9, 0x3042, 0xD83D, 0xDE00, 'z' },
+		{ 'a', 0, 0xC3, 0xA9, 0xE3, 0x81, 0x82, 0xF0, 0x9F, 0x98, 0x80, 'z' },
+		{ 'a', 0xC0, 0x80, 0xC3, 0xA9, 0xE3, 0x81, 0x82, 0xED, 0xA0, 0xBD, 0xED, 0xB8, 0x80, 'z' }, true },
+	{ "unpaired high", { 'a', 0xD800, 'b' }, { 'a', 0xEF, 0xBF, 0xBD, 'b' }, { 'a', 0xED, 0xA0, 0x80, 'b' }, false },
+	{ "unpaired high at end", { 0xDBFF }, { 0xEF, 0xBF, 0xBD }, { 0xED, 0xAF, 0xBF }, false },
+	{ "unpaired low", { 0xDC00, 'b' }, { 0xEF, 0xBF, 0xBD, 'b' }, { 0xED, 0xB0, 0x80, 'b' }, false },
+	{ "reversed pair", { 0xDE00, 0xD83D }, { 0xEF, 0xBF, 0xBD, 0xEF, 0xBF, 0xBD }, { 0xED, 0xB8, 0x80, 0xED, 0xA0, 0xBD }, false },
+	{ "high before pair", { 0xD800, 0xD83D, 0xDE00 }, { 0xEF, 0xBF, 0xBD, 0xF0, 0x9F, 0x98, 0x80 },
+		{ 0xED, 0xA0, 0x80, 0xED, 0xA0, 0xBD, 0xED, 0xB8, 0x80 }, false },
+};
+
+// UTF-8 input other than the forms above: invalid and truncated sequences
+// yield U+FFFD per byte that cannot start a sequence, CESU-8 pairs are
+// joined, and the 4-byte form is accepted in modified UTF-8.
+struct decode_case
+{
+	const char* name;
+	direction d;
+	units in;
+	units expected;
+};
+
+const unsigned fffd_utf8[] = { 0xEF, 0xBF, 0xBD };
+
+units replacements8(std::size_t n)
+{
+	units u;
+	for (std::size_t i = 0; i < n; ++i)
+		u.insert(u.end(), fffd_utf8, fffd_utf8 + 3);
+	return u;
+}
+
+units replacements16(std::size_t n)
+{
+	return units(n, 0xFFFD);
+}
+
+void run_decode_cases()
+{
+	const decode_case cases[] =
+	{
+		{ "truncated 2-byte", utf8_to_utf16, { 0xC3 }, replacements16(1) },
+		{ "truncated 3-byte", utf8_to_utf16, { 0xE3, 0x81 }, replacements16(2) },
+		{ "truncated 4-byte", utf8_to_utf16, { 0xF0, 0x9F, 0x98 }, replacements16(3) },
+		{ "truncated 3-byte", modified_to_utf16, { 0xE3, 0x81 }, replacements16(2) },
+		{ "truncated 3-byte", modified_to_utf8, { 0xE3, 0x81 }, replacements8(2) },
+		{ "truncated 4-byte", utf8_to_modified, { 0xF0, 0x9F, 0x98 }, replacements8(3) },
+		{ "truncated before ASCII", utf8_to_utf16, { 0xE3, 0x81, 'x' }, { 0xFFFD, 0xFFFD, 'x' } },
+		{ "truncated surrogate pair", modified_to_utf16, { 0xED, 0xA0, 0xBD, 0xED, 0xB8 }, { 0xD83D, 0xFFFD, 0xFFFD } },
+		{ "truncated surrogate pair", modified_to_utf8, { 0xED, 0xA0, 0xBD, 0xED, 0xB8 }, replacements8(3) },
+		{ "C0 80 in standard UTF-8", utf8_to_utf16, { 0xC0, 0x80 }, replacements16(2) },
+		{ "C0 80 in standard UTF-8", utf8_to_modified, { 0xC0, 0x80 }, replacements8(2) },
+		{ "raw NUL in modified UTF-8", modified_to_utf16, { 0 }, { 0 } },
+		{ "overlong 2-byte", utf8_to_utf16, { 0xC1, 0x81 }, replacements16(2) },
+		{ "overlong 3-byte", utf8_to_utf16, { 0xE0, 0x80, 0x80 }, replacements16(3) },
+		{ "overlong 4-byte", utf8_to_utf16, { 0xF0, 0x8F, 0xBF, 0xBF }, replacements16(4) },
+		{ "beyond U+10FFFF", utf8_to_utf16, { 0xF4, 0x90, 0x80, 0x80 }, replacements16(4) },
+		{ "F5 lead byte", utf8_to_utf16, { 0xF5, 0x80 }, replacements16(2) },
+		{ "stray continuation", utf8_to_utf16, { 0x80, 'x', 0xBF }, { 0xFFFD, 'x', 0xFFFD } },
+		{ "stray continuation", modified_to_utf8, { 0x80 }, replacements8(1) },
+		{ "CESU-8 pair in standard UTF-8", utf8_to_utf16, { 0xED, 0xA0, 0xBD, 0xED, 0xB8, 0x80 }, { 0xD83D, 0xDE00 } },
+		{ "CESU-8 pair in standard UTF-8", utf8_to_modified, { 0xED, 0xA0, 0xBD, 0xED, 0xB8, 0x80 }, { 0xED, 0xA0, 0xBD, 0xED, 0xB8, 0x80 } },
+		{ "encoded unpaired surrogate", utf8_to_utf16, { 0xED, 0xA0, 0x80 }, replacements16(1) },
+		{ "encoded unpaired surrogate", utf8_to_modified, { 0xED, 0xB0, 0x80 }, replacements8(1) },
+		{ "4-byte form in modified UTF-8", modified_to_utf8, { 0xF0, 0x9F, 0x98, 0x80 }, { 0xF0, 0x9F, 0x98, 0x80 } },
+	};
+	for (const decode_case& c : cases)
+		expect(c.name, c.d, c.in, c.expected);
+}
+
+void run_string_cases()
+{
+	for (const string_case& c : string_cases)
+	{
+		expect(c.name, utf16_to_utf8, c.utf16, c.utf8);
+		expect(c.name, utf16_to_modified, c.utf16, c.modified);
+		expect(c.name, modified_to_utf16, c.modified, c.utf16);
+		expect(c.name, modified_to_utf8, c.modified, c.utf8);
+		expect_in_place(c.name, c.modified, c.utf8);
+		if (c.paired)
+		{
+			expect(c.name, utf8_to_utf16, c.utf8, c.utf16);
+			expect(c.name, utf8_to_modified, c.utf8, c.modified);
+		}
+	}
+}
+
+// Reference encoders for the randomized round trips.
+
+void append_utf8(unsigned long cp, units& out)
+{
+	if (cp < 0x80)
+	{
+		out.push_back(cp);
+	}
+	else if (cp < 0x800)
+	{
+		out.push_back(0xC0 | (cp >> 6));
+		out.push_back(0x80 | (cp & 0x3F));
+	}
+	else if (cp < 0x10000)
+	{
+		out.push_back(0xE0 | (cp >> 12));
+		out.push_back(0x80 | ((cp >> 6) & 0x3F));
+		out.push_back(0x80 | (cp & 0x3F));
+	}
+	else
+	{
+		out.push_back(0xF0 | (cp >> 18));
+		out.push_back(0x80 | ((cp >> 12) & 0x3F));
+		out.push_back(0x80 | ((cp >> 6) & 0x3F));
+		out.push_back(0x80 | (cp & 0x3F));
+	}
+}
+
+bool is_high(unsigned u) { return u >= 0xD800 && u <= 0xDBFF; }
+bool is_low(unsigned u) { return u >= 0xDC00 && u <= 0xDFFF; }
+
+// Unpaired surrogates replaced by U+FFFD.
+units scrub(const units& utf16)
+{
+	units out;
+	for (std::size_t i = 0; i < utf16.size(); ++i)
+	{
+		if (is_high(utf16[i]) && i + 1 < utf16.size() && is_low(utf16[i + 1]))
+		{
+			out.push_back(utf16[i]);
+			out.push_back(utf16[++i]);
+		}
+		else
+		{
+			out.push_back(is_high(utf16[i]) || is_low(utf16[i]) ? 0xFFFD : utf16[i]);
+		}
+	}
+	return out;
+}
+
+units reference_utf8(const units& utf16)
+{
+	units s = scrub(utf16);
+	units out;
+	for (std::size_t i = 0; i < s.size(); ++i)
+	{
+		if (is_high(s[i]))
+		{
+			append_utf8(0x10000 + ((s[i] - 0xD800ul) << 10) + (s[i + 1] - 0xDC00ul), out);
+			++i;
+		}
+		else
+		{
+			append_utf8(s[i], out);
+		}
+	}
+	return out;
+}
+
+units reference_modified(const units& utf16)
+{
+	units out;
+	for (unsigned u : utf16)
+	{
+		if (u == 0)
+		{
+			out.push_back(0xC0);
+			out.push_back(0x80);
+		}
+		else
+		{
+			append_utf8(u, out);
+		}
+	}
+	return out;
+}
+
+units random_utf16(std::mt19937& g, bool unpaired)
+{
+	units s;
+	int pieces = static_cast<int>(g() % 40);
+	for (int i = 0; i < pieces; ++i)
+	{
+		switch (g() % 8)
+		{
+		case 0:
+		case 1:
+		case 2:
+			for (unsigned run = g() % 80; run > 0; --run)
+				s.push_back(1 + g() % 127);
+			break;
+		case 3:
+			s.push_back(0);
+			break;
+		case 4:
+			s.push_back(0x80 + g() % 0x780);
+			break;
+		case 5:
+			s.push_back(0xE000 + g() % 0x2000);
+			break;
+		case 6:
+		{
+			unsigned long cp = g() % 0x100000;
+			s.push_back(0xD800 + (cp >> 10));
+			s.push_back(0xDC00 + (cp & 0x3FF));
+			break;
+		}
+		default:
+			s.push_back(unpaired ? 0xD800 + g() % 0x800 : 0x800 + g() % 0xD000);
+			break;
+		}
+	}
+	return s;
+}
+
+void run_random_cases()
+{
+	std::mt19937 g(20260);
+	for (int i = 0; i < 1000; ++i)
+	{
+		units s = random_utf16(g, i % 2 == 0);
+		units utf8 = reference_utf8(s);
+		units modified = reference_modified(s);
+		expect("random", utf16_to_utf8, s, utf8);
+		expect("random", utf16_to_modified, s, modified);
+		expect("random", modified_to_utf16, modified, s);
+		expect("random", modified_to_utf8, modified, utf8);
+		expect("random", utf8_to_utf16, utf8, scrub(s));
+		expect("random", utf8_to_modified, utf8, reference_modified(scrub(s)));
+		expect_in_place("random", modified, utf8);
+	}
+}
+
+} // unnamed namespace
+
+int main()
+{
+	namespace detail = konata::jni::detail;
+	transcode_isa detected = konata::jni::active_transcode_isa();
+	std::printf("detected: %s\n", isa_names[static_cast<int>(detected)]);
+	for (int i = 0; i <= static_cast<int>(transcode_isa::avx2); ++i)
+	{
+		transcode_isa isa = static_cast<transcode_isa>(i);
+		if (isa > detected)
+		{
+			std::printf("%s: not supported by this CPU, skipped\n", isa_names[i]);
+			continue;
+		}
+		detail::transcode_kernels kernels = detail::make_transcode_kernels(isa);
+		if (kernels.isa != isa)
+		{
+			std::printf("%s: not built for this target, skipped\n", isa_names[i]);
+			continue;
+		}
+		detail::transcode_kernels_override() = &kernels;
+		current_isa = isa_names[i];
+		int before = failures;
+		run_string_cases();
+		run_decode_cases();
+		run_random_cases();
+		std::printf("%s: %d failures\n", isa_names[i], failures - before);
+	}
+	detail::transcode_kernels_override() = nullptr;
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,133 @@
+// test/sqlite3/allocator_bench.cpp
+//
+// Copyright (c) Egtra 2026
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt )
+
+// An insert/select workload on in-memory databases, one per thread, with
+// SQLite's default allocator and with pool_allocator installed through
+// SQLITE_CONFIG_MALLOC. Each run reconfigures SQLite between
+// sqlite3_shutdown() and sqlite3_initialize() with a fresh allocator, and
+// reports statements per second, SQLite's own high-water mark, and for
+// pool_allocator its peak, live (after the connections are closed) and
+// reserved bytes.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <konata/sqlite3/allocator.hpp>
+#include <konata/sqlite3/connection.hpp>
+
+namespace
+{
+
+using namespace konata::sqlite3;
+
+const int rounds = 20;
+const int rows = 2000;
+
+// Keeps the reads from being optimized away.
+volatile std::int64_t sink;
+
+// One connection's life: fill a table, look every row up, scan it.
+void round_trip(int seed)
+{
+	connection db(":memory:");
+	db.exec("CREATE TABLE t(id INTEGER PRIMARY KEY, name TEXT, payload BLOB)");
+	std::vector<unsigned char> payload(200);
+	std::string name;
+	{
+		db.exec("BEGIN");
+		statement insert(db.get(), "INSERT INTO t VALUES(?, ?, ?)");
+		for (int i = 0; i < rows; ++i)
+		{
+			name = "name-" + std::to_string(seed) + "-" + std::to_string(i);
+			payload.resize(static_cast<std::size_t>(16 + (i * 37) % 400));
+			insert.bind(1, i).bind(2, name).bind_blob(3, payload.data(), payload.size());
+			insert.step();
+			insert.reset();
+		}
+		db.exec("COMMIT");
+	}
+	std::int64_t sum = 0;
+	statement lookup(db.get(), "SELECT name, length(payload) FROM t WHERE id = ?");
+	for (int i = 0; i < rows; ++i)
+	{
+		lookup.bind(1, (i * 7919) % rows);
+		if (lookup.step())
+			sum += static_cast<std::int64_t>(lookup.column_string(0).size()) + lookup.column_int64(1);
+		lookup.reset();
+	}
+	statement scan(db.get(), "SELECT count(*), sum(length(name)) FROM t WHERE name LIKE '%7%'");
+	if (scan.step())
+		sum += scan.column_int64(0) + scan.column_int64(1);
+	sink = sum;
+}
+
+void run(bool pooled, int threads)
+{
+	sqlite3_shutdown();
+	std::unique_ptr<pool_allocator> pool;
+	if (pooled)
+	{
+		pool.reset(new pool_allocator());
+		if (pool->install())
+		{
+			std::printf("pool_allocator::install failed\n");
+			std::exit(1);
+		}
+	}
+	sqlite3_initialize();
+	sqlite3_memory_highwater(1);
+
+	auto start = std::chrono::steady_clock::now();
+	std::vector<std::thread> workers;
+	for (int t = 0; t < threads; ++t)
+	{
+		workers.emplace_back([t] {
+			for (int r = 0; r < rounds; ++r)
+				round_trip(t * rounds + r);
+		});
+	}
+	for (auto& w : workers)
+		w.join();
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	double statements = 2.0 * rows * rounds * threads;
+	std::printf("%-6s %7d %14.0f %14lld", pooled ? "pool" : "malloc", threads, statements / seconds,
+		static_cast<long long>(sqlite3_memory_highwater(0)));
+	if (pooled)
+	{
+		pool_allocator_statistics s = pool->statistics();
+		std::printf(" %12llu %12llu %12llu\n", static_cast<unsigned long long>(s.peak_bytes),
+			static_cast<unsigned long long>(s.live_bytes), static_cast<unsigned long long>(s.reserved_bytes));
+	}
+	else
+	{
+		std::printf(" %12s %12s %12s\n", "-", "-", "-");
+	}
+
+	// SQLite frees everything it holds before the allocator goes away.
+	sqlite3_shutdown();
+	pool.reset();
+}
+
+} // unnamed namespace
+
+int main()
+{
+	static const int threadCounts[] = { 1, 2, 4, 8 };
+	std::printf("%-6s %7s %14s %14s %12s %12s %12s\n", "mode", "threads", "statements/s",
+		"sqlite peak", "pool peak", "pool live", "reserved");
+	for (int threads : threadCounts)
+	{
+		run(false, threads);
+		run(true, threads);
+	}
+}
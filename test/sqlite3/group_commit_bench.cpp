@@ -0,0 +1,151 @@
+// test/sqlite3/group_commit_bench.cpp
+//
+// Copyright (c) Egtra 2026
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt )
+
+// Commits and writes per second for 1, 2, 4, ... producers, each doing one
+// small INSERT at a time, through group_commit_writer and through a
+// baseline where every producer has its own connection and runs one
+// transaction per write. The database is in WAL mode with synchronous=FULL,
+// so each commit is an fsync; it is created in the current directory unless
+// a path is given, as the results depend on the file system.
+//
+//     group_commit_bench [database]
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include <konata/sqlite3/connection.hpp>
+#include <konata/sqlite3/group_commit.hpp>
+
+namespace
+{
+
+using namespace konata::sqlite3;
+
+const std::chrono::milliseconds duration(1000);
+
+std::string path = "group_commit_bench.db";
+
+std::string insert_sql(int producer)
+{
+	return "INSERT INTO t(producer, payload) VALUES(" + std::to_string(producer) + ", randomblob(100))";
+}
+
+connection open_database()
+{
+	connection c(path.c_str(), SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX);
+	c.exec("PRAGMA synchronous=FULL");
+	return c;
+}
+
+void remove_database()
+{
+	std::remove(path.c_str());
+	std::remove((path + "-wal").c_str());
+	std::remove((path + "-shm").c_str());
+}
+
+void create_database()
+{
+	remove_database();
+	connection c = open_database();
+	c.exec("PRAGMA journal_mode=WAL");
+	c.exec("CREATE TABLE t(id INTEGER PRIMARY KEY, producer INTEGER, payload BLOB)");
+}
+
+void report(const char* mode, int producers, std::uint64_t writes, std::uint64_t commits, std::uint64_t failures, double seconds)
+{
+	std::printf("%-12s %9d %12.0f %12.0f %14.1f", mode, producers,
+		static_cast<double>(writes) / seconds, static_cast<double>(commits) / seconds,
+		commits != 0 ? static_cast<double>(writes) / static_cast<double>(commits) : 0.0);
+	if (failures != 0)
+		std::printf("  (%llu failed)", static_cast<unsigned long long>(failures));
+	std::printf("\n");
+}
+
+// Runs producer(i, deadline) on `producers` threads; returns the seconds taken.
+template<typename F>
+double run_producers(int producers, F producer)
+{
+	auto start = std::chrono::steady_clock::now();
+	auto deadline = start + duration;
+	std::vector<std::thread> threads;
+	for (int i = 0; i < producers; ++i)
+		threads.emplace_back([&producer, i, deadline] { producer(i, deadline); });
+	for (auto& t : threads)
+		t.join();
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void run_baseline(int producers)
+{
+	create_database();
+	std::atomic<std::uint64_t> writes(0);
+	std::atomic<std::uint64_t> failures(0);
+	double seconds = run_producers(producers, [&](int i, std::chrono::steady_clock::time_point deadline) {
+		connection c = open_database();
+		sqlite3_busy_timeout(c.get(), 5000);
+		std::string sql = "BEGIN IMMEDIATE; " + insert_sql(i) + "; COMMIT";
+		while (std::chrono::steady_clock::now() < deadline)
+		{
+			if (sqlite3_exec(c.get(), sql.c_str(), nullptr, nullptr, nullptr) == SQLITE_OK)
+			{
+				writes.fetch_add(1, std::memory_order_relaxed);
+			}
+			else
+			{
+				failures.fetch_add(1, std::memory_order_relaxed);
+				if (!sqlite3_get_autocommit(c.get()))
+					c.exec("ROLLBACK");
+			}
+		}
+	});
+	report("transaction", producers, writes, writes, failures, seconds);
+}
+
+void run_group_commit(int producers)
+{
+	create_database();
+	std::atomic<std::uint64_t> writes(0);
+	std::atomic<std::uint64_t> failures(0);
+	double seconds;
+	group_commit_statistics s;
+	{
+		group_commit_writer writer(open_database());
+		seconds = run_producers(producers, [&](int i, std::chrono::steady_clock::time_point deadline) {
+			std::string sql = insert_sql(i);
+			while (std::chrono::steady_clock::now() < deadline)
+			{
+				std::error_code ec = writer.submit([&sql](connection& c) { c.exec(sql); }).get();
+				(ec ? failures : writes).fetch_add(1, std::memory_order_relaxed);
+			}
+		});
+		s = writer.statistics();
+	}
+	report("group_commit", producers, writes, s.transactions, failures, seconds);
+}
+
+} // unnamed namespace
+
+int main(int argc, char** argv)
+{
+	if (argc > 1)
+		path = argv[1];
+	static const int producerCounts[] = { 1, 2, 4, 8, 16, 32 };
+	std::printf("%-12s %9s %12s %12s %14s\n", "mode", "producers", "writes/s", "commits/s", "writes/commit");
+	for (int producers : producerCounts)
+	{
+		run_baseline(producers);
+		run_group_commit(producers);
+	}
+	remove_database();
+}
@@ -0,0 +1,118 @@
+// test/sqlite3/query_test.cpp
+//
+// Copyright (c) Egtra 2026
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt )
+
+// Checks the declared-type checks of typed_query: which column types each
+// row element type accepts when the query is prepared, and what it reads.
+
+#include <cstdint>
+#include <cstdio>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <tuple>
+#include <konata/sqlite3/connection.hpp>
+#include <konata/sqlite3/query.hpp>
+
+namespace
+{
+
+using namespace konata::sqlite3;
+
+int failures = 0;
+
+void check(bool ok, const std::string& what)
+{
+	if (!ok)
+	{
+		++failures;
+		std::printf("FAIL %s\n", what.c_str());
+	}
+}
+
+// The error code typed_query<Row> reports for sql, 0 if none.
+template<typename Row>
+int prepare_error(connection& db, const char* sql)
+{
+	try
+	{
+		typed_query<Row> q(db.get(), sql);
+		return 0;
+	}
+	catch (const std::system_error& e)
+	{
+		return e.code().value();
+	}
+}
+
+// Any declared type can be read as a string; NUMERIC ones (DATETIME, DATE,
+// DECIMAL, BOOLEAN) commonly hold text.
+void test_strings(connection& db)
+{
+	struct column
+	{
+		const char* declared;
+		const char* value;
+		const char* text;
+	};
+	const column columns[] =
+	{
+		{ "DATETIME", "'2026-10-18 12:34:56'", "2026-10-18 12:34:56" },
+		{ "DATE", "'2026-10-18'", "2026-10-18" },
+		{ "DECIMAL(10,2)", "12.5", "12.5" },
+		{ "BOOLEAN", "1", "1" },
+		{ "NUMERIC", "'n/a'", "n/a" },
+		{ "INTEGER", "42", "42" },
+		{ "REAL", "0.25", "0.25" },
+		{ "VARCHAR(8)", "'text'", "text" },
+		{ "BLOB", "x'6869'", "hi" },
+		{ "", "'none'", "none" },
+	};
+	for (const column& c : columns)
+	{
+		std::string declared = c.declared;
+		db.exec("DROP TABLE IF EXISTS t");
+		db.exec("CREATE TABLE t(c " + declared + ")");
+		db.exec(std::string("INSERT INTO t VALUES(") + c.value + ")");
+		try
+		{
+			typed_query<std::tuple<std::string>> q(db.get(), "SELECT c FROM t");
+			check(q.next() && std::get<0>(q.row()) == c.text, "std::string from " + declared);
+			typed_query<std::tuple<std::string_view>> v(db.get(), "SELECT c FROM t");
+			check(v.next() && std::get<0>(v.row()) == c.text, "std::string_view from " + declared);
+			typed_query<std::tuple<std::optional<std::string>>> o(db.get(), "SELECT c FROM t");
+			check(o.next() && std::get<0>(o.row()) == std::optional<std::string>(c.text), "std::optional<std::string> from " + declared);
+		}
+		catch (const std::system_error& e)
+		{
+			check(false, "string from " + declared + ": " + e.what());
+		}
+	}
+}
+
+// Numbers are still refused where the declared type says text.
+void test_mismatches(connection& db)
+{
+	db.exec("CREATE TABLE u(name TEXT, created_at DATETIME, n INTEGER)");
+	check(prepare_error<std::tuple<std::int64_t>>(db, "SELECT name FROM u") == SQLITE_MISMATCH, "std::int64_t from TEXT");
+	check(prepare_error<std::tuple<double>>(db, "SELECT name FROM u") == SQLITE_MISMATCH, "double from TEXT");
+	check(prepare_error<std::tuple<std::int64_t>>(db, "SELECT created_at FROM u") == 0, "std::int64_t from DATETIME");
+	check(prepare_error<std::tuple<std::string, std::string, std::int64_t>>(db, "SELECT name, created_at, n FROM u") == 0, "mixed row");
+	check(prepare_error<std::tuple<std::string>>(db, "SELECT name, n FROM u") == SQLITE_RANGE, "column count");
+}
+
+} // unnamed namespace
+
+int main()
+{
+	connection c(":memory:");
+	test_strings(c);
+	test_mismatches(c);
+	std::printf("%d failures\n", failures);
+	return failures == 0 ? 0 : 1;
+}